@@ -0,0 +1,266 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// corpus.cpp
+// canonical input strings for benchmarks
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2011 Hideo Bannai
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "corpus.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+
+using namespace std;
+
+// 1558 characters with 1455 runs (see tests/runFinderTest.cpp)
+static const char * RUN_RICH =
+  "1101011010010110101101001011010110011010110100101101011010010110"
+  "1011001011010110100101101011010010110101100110101101001011010110"
+  "1001011010110010110101101001011010110010110100101101011010010110"
+  "1011001011010110100101101011010010110101100101101001011010110100"
+  "1011010110010110101101001011010110010110100101101011010010110101"
+  "1001011010110100101101011010010110101100101101011010010110101100"
+  "1011010010110101101001011010110010110101101001011010110100101101"
+  "0110010110100101101011010010110101100101101011010010110101100101"
+  "1010010110101101001011010110010110101101001011010110100101101011"
+  "0010110101101001011010110010110100101101011010010110101100101101"
+  "0110100101101011001011010010110101101001011010110010110101101001"
+  "0110101101001011010110010110100101101011010010110101100101101011"
+  "0100101101011001011010010110101101001011010110010110101101001011"
+  "0101101001011010110010110101101001011010110010110100101101011010"
+  "0101101011001011010110100101101011010010110101100101101001011010"
+  "1101001011010110010110101101001011010110010110100101101011010010"
+  "1101011001011010110100101101011010010110101100101101011010010110"
+  "1011001011010010110101101001011010110010110101101001011010110010"
+  "1101001011010110100101101011001011010110100101101011010010110101"
+  "1001011010010110101101001011010110010110101101001011010110010110"
+  "1001011010110100101101011001011010110100101101011010010110101100"
+  "1011010110100101101011001011010010110101101001011010110010110101"
+  "1010010110101101001011010110010110100101101011010010110101100101"
+  "1010110100101101011001011010010110101101001011010110010110101101"
+  "0010110101101001011010";
+
+static const char * NAMES[NUM_CORPORA] = {
+  "random-binary", "random-dna", "random-byte",
+  "fibonacci", "thue-morse", "run-rich", "unary",
+  "random", "sturmian", "period-doubling", "tandem"
+};
+
+static const size_t CHUNK = 1 << 20;
+
+////////////////////////////////////////////////////////////////////////////////
+
+CorpusParams::CorpusParams()
+  : seed(1), alphabet("abcdefghijklmnopqrstuvwxyz"), directive(1, 1),
+    period(100), mutation(0.01)
+{
+  directive.push_back(2);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+CorpusGenerator::CorpusGenerator(enum CORPUS c, const CorpusParams & p)
+  : corpus(c), params(p), pos(0), rng(0x9e3779b97f4a7c15ULL ^ p.seed), root(2)
+{
+  switch(c){
+  case CORPUS_RANDOM_BINARY: params.alphabet = "ab"; break;
+  case CORPUS_RANDOM_DNA:    params.alphabet = "acgt"; break;
+  case CORPUS_FIBONACCI:     params.directive.assign(1, 1); break;
+  default: break;
+  }
+  if(params.alphabet.empty()) params.alphabet = "a";
+  if(params.directive.empty()) params.directive.assign(1, 1);
+  if(c == CORPUS_TANDEM){
+    unit.resize(params.period > 0 ? params.period : 1);
+    for(size_t i = 0; i < unit.size(); i++){
+      unit[i] = params.alphabet[(nextRandom() >> 32) % params.alphabet.size()];
+    }
+  }
+  stack.push_back(make_pair(root, 0u));
+}
+
+// xorshift64*: a small generator with the same output everywhere
+unsigned long long CorpusGenerator::nextRandom(){
+  rng ^= rng >> 12;
+  rng ^= rng << 25;
+  rng ^= rng >> 27;
+  return rng * 2685821657736338717ULL;
+}
+
+// next character of the sturmian word, by a depth first walk of the
+// derivation tree of s_root. a frame (l, i) stands for the parts i, i+1, ...
+// of s_{l-1}: parts 0..d-1 are s_{l-2} and part d is s_{l-3}, where d is
+// the directive of s_{l-1}. levels 0 and 1 are the letters b and a.
+// s_k is a prefix of s_{k+1}, so when s_root is done the walk continues
+// with part 1 of s_{root+1}.
+char CorpusGenerator::sturmian(){
+  while(true){
+    if(stack.empty()) stack.push_back(make_pair(++root, 1u));
+    pair<unsigned int, unsigned int> & f = stack.back();
+    if(f.first <= 1){
+      char c = (f.first == 1) ? 'a' : 'b';
+      stack.pop_back();
+      return c;
+    }
+    unsigned int d = params.directive[(f.first - 2) % params.directive.size()];
+    if(d == 0) d = 1;
+    unsigned int child = (f.second < d) ? f.first - 1 : f.first - 2;
+    if(++f.second > d) stack.pop_back();
+    stack.push_back(make_pair(child, 0u));
+  }
+}
+
+void CorpusGenerator::fill(char * buf, size_t len){
+  size_t i, rrlen = strlen(RUN_RICH), sigma = params.alphabet.size();
+  const char * alpha = params.alphabet.data();
+  switch(corpus){
+  case CORPUS_RANDOM_BINARY:
+  case CORPUS_RANDOM_DNA:
+  case CORPUS_RANDOM:
+    for(i = 0; i < len; i++) buf[i] = alpha[(nextRandom() >> 32) % sigma];
+    break;
+  case CORPUS_RANDOM_BYTE:
+    for(i = 0; i < len; i++) buf[i] = static_cast<char>(nextRandom() >> 56);
+    break;
+  case CORPUS_FIBONACCI:
+  case CORPUS_STURMIAN:
+    for(i = 0; i < len; i++) buf[i] = sturmian();
+    break;
+  case CORPUS_THUE_MORSE:
+    for(i = 0; i < len; i++) buf[i] = (__builtin_popcountll(pos + i) & 1) ? 'b' : 'a';
+    break;
+  case CORPUS_PERIOD_DOUBLING:
+    for(i = 0; i < len; i++) buf[i] = (__builtin_ctzll(pos + i + 1) & 1) ? 'b' : 'a';
+    break;
+  case CORPUS_RUN_RICH:
+    for(i = 0; i < len; i++) buf[i] = RUN_RICH[(pos + i) % rrlen];
+    break;
+  case CORPUS_TANDEM:
+    for(i = 0; i < len; i++){
+      buf[i] = unit[(pos + i) % unit.size()];
+      if(sigma > 1 && (nextRandom() >> 11) * (1.0 / (1ULL << 53)) < params.mutation){
+	size_t k = params.alphabet.find(buf[i]);
+	buf[i] = alpha[(k + 1 + nextRandom() % (sigma - 1)) % sigma];
+      }
+    }
+    break;
+  default:
+    memset(buf, 'a', len);
+    break;
+  }
+  pos += len;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+const char * Corpus::name(enum CORPUS c){
+  return (c < NUM_CORPORA) ? NAMES[c] : "unknown";
+}
+
+bool Corpus::parse(const char * name, enum CORPUS & c){
+  for(unsigned int i = 0; i < NUM_CORPORA; i++){
+    if(strcmp(name, NAMES[i]) == 0){
+      c = static_cast<enum CORPUS>(i);
+      return true;
+    }
+  }
+  return false;
+}
+
+bool Corpus::parseList(const char * names, vector<enum CORPUS> & corpora){
+  string list(names);
+  size_t b = 0, e;
+  enum CORPUS c;
+  corpora.clear();
+  do {
+    e = list.find(',', b);
+    if(!parse(list.substr(b, e - b).c_str(), c)) return false;
+    corpora.push_back(c);
+    b = e + 1;
+  } while(e != string::npos);
+  return true;
+}
+
+size_t Corpus::parseSize(const char * str){
+  char * e;
+  size_t n = strtoul(str, &e, 10);
+  switch(*e){
+  case 'k': case 'K': n <<= 10; e++; break;
+  case 'm': case 'M': n <<= 20; e++; break;
+  case 'g': case 'G': n <<= 30; e++; break;
+  }
+  return (*e == '\0') ? n : 0;
+}
+
+void Corpus::generate(enum CORPUS c, size_t n, string & s, unsigned int seed){
+  CorpusParams p;
+  p.seed = seed;
+  generate(c, n, s, p);
+}
+
+void Corpus::generate(enum CORPUS c, size_t n, string & s, const CorpusParams & p){
+  CorpusGenerator gen(c, p);
+  s.resize(n);
+  if(n > 0) gen.fill(&s[0], n);
+}
+
+// write all of buf[0..n-1] to fd
+static bool writeAll(int fd, const char * buf, size_t n){
+  while(n > 0){
+    ssize_t r = ::write(fd, buf, n);
+    if(r < 0){
+      if(errno == EINTR) continue;
+      return false;
+    }
+    buf += r;
+    n -= r;
+  }
+  return true;
+}
+
+bool Corpus::write(enum CORPUS c, size_t n, int fd, const CorpusParams & p, size_t width){
+  CorpusGenerator gen(c, p);
+  vector<char> buf(CHUNK + (width ? CHUNK / width + 2 : 0));
+  size_t col = 0;
+  while(n > 0){
+    size_t len = min(n, CHUNK), out = 0;
+    if(width == 0){
+      gen.fill(&buf[0], len);
+      out = len;
+    } else {
+      // break lines while filling
+      for(size_t done = 0; done < len; ){
+	size_t l = min(len - done, width - col);
+	gen.fill(&buf[out], l);
+	out += l;
+	done += l;
+	if((col += l) == width){
+	  buf[out++] = '\n';
+	  col = 0;
+	}
+      }
+    }
+    n -= len;
+    if(n == 0 && col > 0) buf[out++] = '\n';
+    if(!writeAll(fd, &buf[0], out)) return false;
+  }
+  return true;
+}
@@ -0,0 +1,96 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// corpus.hpp
+// canonical input strings for benchmarks
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2011 Hideo Bannai
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __CORPUS_HPP__
+#define __CORPUS_HPP__
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+enum CORPUS {
+  CORPUS_RANDOM_BINARY,  // uniform random over "ab"
+  CORPUS_RANDOM_DNA,     // uniform random over "acgt"
+  CORPUS_RANDOM_BYTE,    // uniform random over all 256 bytes
+  CORPUS_FIBONACCI,      // prefix of the infinite fibonacci word "abaababaab..."
+  CORPUS_THUE_MORSE,     // prefix of the thue-morse word "abbabaab..."
+  CORPUS_RUN_RICH,       // the run-rich string of runFinderTest (1558 chars, 1455 runs), repeated
+  CORPUS_UNARY,          // a^n
+  CORPUS_RANDOM,         // uniform random over CorpusParams::alphabet
+  CORPUS_STURMIAN,       // standard sturmian word of CorpusParams::directive
+  CORPUS_PERIOD_DOUBLING,// prefix of the period-doubling word "abaaabab..."
+  CORPUS_TANDEM,         // tandem array of a random unit with random substitutions
+  NUM_CORPORA
+};
+
+// parameters of the generated strings
+class CorpusParams {
+public:
+  unsigned int seed;                    // of the random choices
+  std::string alphabet;                 // CORPUS_RANDOM and CORPUS_TANDEM
+  // CORPUS_STURMIAN: s_{-1} = b, s_0 = a, s_k = s_{k-1}^{d_k} s_{k-2},
+  // where d_1, d_2, ... repeats directive. all 1 gives the fibonacci word.
+  std::vector<unsigned int> directive;
+  size_t period;                        // CORPUS_TANDEM: length of the unit
+  double mutation;                      // CORPUS_TANDEM: probability each character is substituted
+  CorpusParams();
+};
+
+// produces the string of a corpus from left to right, so strings of any
+// size can be streamed. the random corpora are the same on all platforms.
+class CorpusGenerator {
+  enum CORPUS corpus;
+  CorpusParams params;
+  size_t pos;                           // characters produced so far
+  unsigned long long rng;
+  std::string unit;                     // CORPUS_TANDEM
+  std::vector<std::pair<unsigned int, unsigned int> > stack;  // CORPUS_STURMIAN: (level, part)
+  unsigned int root;
+  unsigned long long nextRandom();
+  char sturmian();
+public:
+  CorpusGenerator(enum CORPUS c, const CorpusParams & p = CorpusParams());
+  // write the next len characters to buf
+  void fill(char * buf, size_t len);
+  size_t position() const { return pos; }
+};
+
+class Corpus {
+public:
+  // name of corpus c, as accepted by parse
+  static const char * name(enum CORPUS c);
+  // corpus named name. false if there is none.
+  static bool parse(const char * name, enum CORPUS & c);
+  // corpora of a comma separated list of names. false if some name is unknown.
+  static bool parseList(const char * names, std::vector<enum CORPUS> & corpora);
+  // size such as 4096, 64K, 16M or 1G. returns 0 on error.
+  static size_t parseSize(const char * str);
+  // set s to the string of length n of corpus c.
+  static void generate(enum CORPUS c, size_t n, std::string & s, unsigned int seed = 1);
+  static void generate(enum CORPUS c, size_t n, std::string & s, const CorpusParams & p);
+  // write the string of length n of corpus c to fd, with a newline after
+  // every width characters if width > 0. false on write error.
+  static bool write(enum CORPUS c, size_t n, int fd, const CorpusParams & p, size_t width = 0);
+};
+
+#endif//__CORPUS_HPP__
@@ -1719,35 +1719,60 @@ construct_BWT(const unsigned char *T, int *SA,
 
 int
 divsufsort(const unsigned char *T, int *SA, int n) {
+  int *work;
+  int err;
+
+  /* Check arguments. */
+  if((T == NULL) || (SA == NULL) || (n < 0)) { return -1; }
+  else if(n <= 2) { return divsufsort_ws(T, SA, n, NULL); }
+
+  work = (int *)malloc(DIVSUFSORT_WORK_SIZE * sizeof(int));
+  err = (work != NULL) ? divsufsort_ws(T, SA, n, work) : -2;
+  free(work);
+
+  return err;
+}
+
+int
+divsufsort_ws(const unsigned char *T, int *SA, int n, int *work) {
   int *bucket_A, *bucket_B;
   int m;
-  int err = 0;
 
   /* Check arguments. */
   if((T == NULL) || (SA == NULL) || (n < 0)) { return -1; }
   else if(n == 0) { return 0; }
   else if(n == 1) { SA[0] = 0; return 0; }
   else if(n == 2) { m = (T[0] < T[1]); SA[m ^ 1] = 0, SA[m] = 1; return 0; }
+  else if(work == NULL) { return -2; }
 
-  bucket_A = (int *)malloc(BUCKET_A_SIZE * sizeof(int));
-  bucket_B = (int *)malloc(BUCKET_B_SIZE * sizeof(int));
+  bucket_A = work;
+  bucket_B = work + BUCKET_A_SIZE;
 
   /* Suffixsort. */
-  if((bucket_A != NULL) && (bucket_B != NULL)) {
-    m = sort_typeBstar(T, SA, bucket_A, bucket_B, n);
-    construct_SA(T, SA, bucket_A, bucket_B, n, m);
-  } else {
-    err = -2;
-  }
+  m = sort_typeBstar(T, SA, bucket_A, bucket_B, n);
+  construct_SA(T, SA, bucket_A, bucket_B, n, m);
 
-  free(bucket_B);
-  free(bucket_A);
-
-  return err;
+  return 0;
 }
 
 int
 divbwt(const unsigned char *T, unsigned char *U, int *A, int n) {
+  int *work;
+  int pidx;
+
+  /* Check arguments. */
+  if((T == NULL) || (U == NULL) || (n < 0)) { return -1; }
+  else if(n <= 1) { return divbwt_ws(T, U, A, n, NULL); }
+
+  work = (int *)malloc(DIVSUFSORT_WORK_SIZE * sizeof(int));
+  pidx = (work != NULL) ? divbwt_ws(T, U, A, n, work) : -2;
+  free(work);
+
+  return pidx;
+}
+
+int
+divbwt_ws(const unsigned char *T, unsigned char *U, int *A, int n, int *work) {
   int *B;
   int *bucket_A, *bucket_B;
   int m, pidx, i;
@@ -1755,13 +1780,14 @@ divbwt(const unsigned char *T, unsigned char *U, int *A, int n) {
   /* Check arguments. */
   if((T == NULL) || (U == NULL) || (n < 0)) { return -1; }
   else if(n <= 1) { if(n == 1) { U[0] = T[0]; } return n; }
+  else if(work == NULL) { return -2; }
 
   if((B = A) == NULL) { B = (int *)malloc((size_t)(n + 1) * sizeof(int)); }
-  bucket_A = (int *)malloc(BUCKET_A_SIZE * sizeof(int));
-  bucket_B = (int *)malloc(BUCKET_B_SIZE * sizeof(int));
+  bucket_A = work;
+  bucket_B = work + BUCKET_A_SIZE;
 
   /* Burrows-Wheeler Transform. */
-  if((B != NULL) && (bucket_A != NULL) && (bucket_B != NULL)) {
+  if(B != NULL) {
     m = sort_typeBstar(T, B, bucket_A, bucket_B, n);
     pidx = construct_BWT(T, B, bucket_A, bucket_B, n, m);
 
@@ -1774,8 +1800,6 @@ divbwt(const unsigned char *T, unsigned char *U, int *A, int n) {
     pidx = -2;
   }
 
-  free(bucket_B);
-  free(bucket_A);
   if(A == NULL) { free(B); }
 
   return pidx;
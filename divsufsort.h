@@ -55,6 +55,27 @@ divsufsort(const unsigned char *T, int *SA, int n);
 int
 divbwt(const unsigned char *T, unsigned char *U, int *A, int n);
 
+/* Size (in ints) of the work space of divsufsort_ws and divbwt_ws. */
+#define DIVSUFSORT_WORK_SIZE (256 + 256 * 256)
+
+/**
+ * Constructs the suffix array of a given string, as divsufsort, with the
+ * buckets in a work space given by the caller instead of allocated.
+ * @param work[0..DIVSUFSORT_WORK_SIZE-1] The work space.
+ * @return 0 if no error occurred, -1 or -2 otherwise.
+ */
+int
+divsufsort_ws(const unsigned char *T, int *SA, int n, int *work);
+
+/**
+ * Constructs the burrows-wheeler transformed string of a given string, as
+ * divbwt, with the buckets in a work space given by the caller.
+ * @param work[0..DIVSUFSORT_WORK_SIZE-1] The work space.
+ * @return The primary index if no error occurred, -1 or -2 otherwise.
+ */
+int
+divbwt_ws(const unsigned char *T, unsigned char *U, int *A, int n, int *work);
+
 
 #ifdef __cplusplus
 } /* extern "C" */
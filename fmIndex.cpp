@@ -0,0 +1,252 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// fmIndex.cpp
+// succinct rank structures and an FM-index over the burrows-wheeler transform
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2011 Hideo Bannai
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "fmIndex.hpp"
+#include "divsufsort.h"
+#include <cassert>
+#include <algorithm>
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////////////
+
+void RankBitVector::init(unsigned int n_){
+  n = n_;
+  bits.assign((n >> 6) + 1, 0);
+  super.clear();
+}
+
+void RankBitVector::build(){
+  unsigned int r = 0;
+  super.assign((bits.size() >> 3) + 1, 0);
+  for(unsigned int w = 0; w < bits.size(); w++){
+    if((w & 7) == 0) super[w >> 3] = r;
+    r += __builtin_popcountll(bits[w]);
+  }
+}
+
+unsigned int RankBitVector::rank1(unsigned int i) const {
+  unsigned int w = i >> 6, r = super[w >> 3];
+  for(unsigned int j = w & ~7u; j < w; j++) r += __builtin_popcountll(bits[j]);
+  if(i & 63) r += __builtin_popcountll(bits[w] & ((1ULL << (i & 63)) - 1));
+  return r;
+}
+
+size_t RankBitVector::bytes() const {
+  return bits.capacity() * sizeof(unsigned long long) + super.capacity() * sizeof(unsigned int);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// each level holds one bit of the codes, from the highest. the codes are
+// then stably partitioned by that bit, zeros first, for the next level.
+void WaveletMatrix::build(unsigned char * codes, unsigned int n_, unsigned int levels_){
+  n = n_;
+  levels = levels_;
+  bv.assign(levels, RankBitVector());
+  zeros.assign(levels, 0);
+  ResourceVector<unsigned char>::type ones;
+  for(unsigned int l = 0; l < levels; l++){
+    unsigned int shift = levels - 1 - l, z = 0;
+    bv[l].init(n);
+    ones.clear();
+    for(unsigned int i = 0; i < n; i++){
+      if((codes[i] >> shift) & 1){
+	bv[l].set(i);
+	ones.push_back(codes[i]);
+      } else {
+	codes[z++] = codes[i];
+      }
+    }
+    bv[l].build();
+    zeros[l] = z;
+    copy(ones.begin(), ones.end(), codes + z);
+  }
+}
+
+unsigned int WaveletMatrix::access(unsigned int i) const {
+  unsigned int c;
+  inverseSelect(i, c);
+  return c;
+}
+
+unsigned int WaveletMatrix::rank(unsigned int c, unsigned int i) const {
+  unsigned int b = 0;                   // beginning of the range of the prefix of c
+  for(unsigned int l = 0; l < levels; l++){
+    if((c >> (levels - 1 - l)) & 1){
+      i = zeros[l] + bv[l].rank1(i);
+      b = zeros[l] + bv[l].rank1(b);
+    } else {
+      i = bv[l].rank0(i);
+      b = bv[l].rank0(b);
+    }
+  }
+  return i - b;
+}
+
+unsigned int WaveletMatrix::inverseSelect(unsigned int i, unsigned int & c) const {
+  unsigned int b = 0;
+  c = 0;
+  for(unsigned int l = 0; l < levels; l++){
+    if(bv[l].get(i)){
+      c = (c << 1) | 1;
+      i = zeros[l] + bv[l].rank1(i);
+      b = zeros[l] + bv[l].rank1(b);
+    } else {
+      c <<= 1;
+      i = bv[l].rank0(i);
+      b = bv[l].rank0(b);
+    }
+  }
+  return i - b;
+}
+
+size_t WaveletMatrix::bytes() const {
+  size_t b = zeros.capacity() * sizeof(unsigned int);
+  for(unsigned int l = 0; l < bv.size(); l++) b += bv[l].bytes();
+  return b;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+FMIndex::FMIndex(const unsigned char * t, unsigned int n_, unsigned int sampleRate_)
+  : n(n_), pidx(0), sampleRate(sampleRate_ > 0 ? sampleRate_ : 1)
+{
+  unsigned int i, c, sigma = 0, levels = 1;
+  UIntArray count(256, 0);
+  for(i = 0; i < n; i++) count[t[i]]++;
+  C.push_back(1);                       // row 0 is $
+  for(c = 0; c < 256; c++){
+    occurs[c] = (count[c] > 0);
+    code[c] = sigma;
+    if(occurs[c]){
+      C.push_back(C.back() + count[c]);
+      sigma++;
+    }
+  }
+  while((1u << levels) < sigma) levels++;
+  ResourceVector<unsigned char>::type bwt(n);
+  if(n > 0){
+    ResourceVector<int>::type A(n + 1), work(DIVSUFSORT_WORK_SIZE);
+    int r = divbwt_ws(t, &bwt[0], &A[0], n, &work[0]);
+    assert(r >= 0);
+    pidx = r;
+  }
+  for(i = 0; i < n; i++) bwt[i] = code[bwt[i]];
+  wm.build(n > 0 ? &bwt[0] : NULL, n, levels);
+  freeVector(bwt);
+
+  // sample by walking the text backwards from row 0 (position n)
+  ResourceVector<pair<unsigned int, unsigned int> >::type s;
+  unsigned int r = 0, p = n;
+  while(p > 0){
+    r = lf(r);
+    p--;
+    if(p % sampleRate == 0) s.push_back(make_pair(r, p));
+  }
+  sort(s.begin(), s.end());
+  sampled.init(n + 1);
+  samples.resize(s.size());
+  for(i = 0; i < s.size(); i++){
+    sampled.set(s[i].first);
+    samples[i] = s[i].second;
+  }
+  sampled.build();
+}
+
+bool FMIndex::extend(unsigned char c, unsigned int & lo, unsigned int & hi) const {
+  if(!occurs[c]){
+    lo = hi = 0;
+    return false;
+  }
+  unsigned int k = code[c];
+  lo = C[k] + rankL(k, lo);
+  hi = C[k] + rankL(k, hi);
+  return lo < hi;
+}
+
+unsigned int FMIndex::lf(unsigned int r) const {
+  unsigned int k;
+  assert(r != pidx);
+  unsigned int rank = wm.inverseSelect(r < pidx ? r : r - 1, k);
+  return C[k] + rank;
+}
+
+unsigned int FMIndex::locate(unsigned int r) const {
+  unsigned int k = 0;
+  while(r != 0 && !sampled.get(r)){
+    r = lf(r);
+    k++;
+  }
+  return (r == 0 ? n : samples[sampled.rank1(r)]) + k;
+}
+
+size_t FMIndex::bytes() const {
+  return C.capacity() * sizeof(unsigned int) + wm.bytes() + sampled.bytes()
+    + samples.capacity() * sizeof(unsigned int) + sizeof(*this);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+const unsigned int SuccessorSet::NONE;
+
+SuccessorSet::SuccessorSet(unsigned int n){
+  size_t words = (n >> 6) + 1;
+  while(true){
+    levels.push_back(ResourceVector<unsigned long long>::type(words, 0));
+    if(words == 1) break;
+    words = (words >> 6) + 1;
+  }
+}
+
+void SuccessorSet::insert(unsigned int x){
+  for(unsigned int l = 0; l < levels.size(); l++){
+    levels[l][x >> 6] |= 1ULL << (x & 63);
+    x >>= 6;
+  }
+}
+
+// up the levels until a word has a member after x, then down to the
+// smallest member below it
+unsigned int SuccessorSet::next(unsigned int x) const {
+  unsigned int l = 0;
+  unsigned long long m;
+  while(true){
+    if((x >> 6) >= levels[l].size()) return NONE;
+    m = levels[l][x >> 6] & (~0ULL << (x & 63));
+    if(m){
+      x = (x & ~63u) + __builtin_ctzll(m);
+      break;
+    }
+    if(++l == levels.size()) return NONE;
+    x = (x >> 6) + 1;                    // the words after that of x
+  }
+  while(l-- > 0) x = (x << 6) + __builtin_ctzll(levels[l][x]);
+  return x;
+}
+
+size_t SuccessorSet::bytes() const {
+  size_t b = 0;
+  for(unsigned int l = 0; l < levels.size(); l++) b += levels[l].capacity() * sizeof(unsigned long long);
+  return b;
+}
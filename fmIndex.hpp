@@ -0,0 +1,121 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// fmIndex.hpp
+// succinct rank structures and an FM-index over the burrows-wheeler transform
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2011 Hideo Bannai
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+#ifndef __FM_INDEX_HPP__
+#define __FM_INDEX_HPP__
+
+#include <cstddef>
+#include <vector>
+#include "memoryResource.hpp"
+
+// bit vector with rank in constant time. the ranks are sampled every 512
+// bits, i.e. 6.25% on top of the bits.
+class RankBitVector {
+  ResourceVector<unsigned long long>::type bits;
+  UIntArray super;                    // ones before every 8th word
+  unsigned int n;
+public:
+  RankBitVector() : n(0) {}
+  // n zeros
+  void init(unsigned int n_);
+  void set(unsigned int i){ bits[i >> 6] |= 1ULL << (i & 63); }
+  bool get(unsigned int i) const { return (bits[i >> 6] >> (i & 63)) & 1; }
+  // must be called after the bits are set, before rank
+  void build();
+  // number of ones (zeros) in [0, i)
+  unsigned int rank1(unsigned int i) const;
+  unsigned int rank0(unsigned int i) const { return i - rank1(i); }
+  unsigned int size() const { return n; }
+  size_t bytes() const;
+};
+
+// wavelet matrix of a sequence of codes of the given number of bits:
+// access and rank in time linear in the number of bits, in about
+// 1.06 bits per bit of the codes.
+// see: F. Claude, G. Navarro and A. Ordonez, The Wavelet Matrix.
+// Information Systems 47: 15-32 (2015)
+class WaveletMatrix {
+  unsigned int n, levels;
+  ResourceVector<RankBitVector>::type bv;
+  UIntArray zeros;                    // number of zeros of each level
+public:
+  WaveletMatrix() : n(0), levels(0) {}
+  // codes[0..n-1] < 2^levels. codes is used as work space and destroyed.
+  void build(unsigned char * codes, unsigned int n_, unsigned int levels_);
+  unsigned int access(unsigned int i) const;
+  // occurrences of c in [0, i)
+  unsigned int rank(unsigned int c, unsigned int i) const;
+  // the code c at i and its occurrences in [0, i), in one pass
+  unsigned int inverseSelect(unsigned int i, unsigned int & c) const;
+  size_t bytes() const;
+};
+
+// FM-index of a text t[0..n-1], from its burrows-wheeler transform by
+// divbwt. the n+1 rows are the sorted suffixes of t$, row 0 being $.
+// the suffix array is sampled at the text positions that are multiples
+// of sampleRate.
+// see: P. Ferragina and G. Manzini, Opportunistic Data Structures with
+// Applications. FOCS 2000: 390-398
+class FMIndex {
+  unsigned int n, pidx;               // $ is the last character of row pidx
+  unsigned int sampleRate;
+  unsigned char code[256];            // code of each character that occurs
+  bool occurs[256];
+  UIntArray C;                        // first row of the suffixes beginning with each code
+  WaveletMatrix wm;                   // codes of the bwt without $
+  RankBitVector sampled;              // rows whose position is sampled
+  UIntArray samples;                  // their positions, by row
+  FMIndex(const FMIndex &);
+  FMIndex & operator=(const FMIndex &);
+  unsigned int rankL(unsigned int c, unsigned int r) const {
+    return wm.rank(c, r <= pidx ? r : r - 1);
+  }
+public:
+  // the construction takes about 6n bytes of work space
+  FMIndex(const unsigned char * t, unsigned int n_, unsigned int sampleRate_ = 32);
+  // number of rows
+  unsigned int rows() const { return n + 1; }
+  // rows [lo, hi) of the suffixes beginning with a pattern p, to those of
+  // cp. returns false if cp does not occur (lo == hi).
+  bool extend(unsigned char c, unsigned int & lo, unsigned int & hi) const;
+  // row of the suffix beginning one position before that of row r
+  // (r must not be the row of the whole text)
+  unsigned int lf(unsigned int r) const;
+  // text position of the suffix of row r
+  unsigned int locate(unsigned int r) const;
+  size_t bytes() const;
+};
+
+// set of integers in [0, n) with the smallest member not less than x,
+// in n bits and a 64-ary summary of the nonempty words.
+class SuccessorSet {
+  ResourceVector<ResourceVector<unsigned long long>::type>::type levels;
+public:
+  static const unsigned int NONE = 0xffffffffu;
+  SuccessorSet(unsigned int n);
+  void insert(unsigned int x);
+  // smallest member >= x (NONE: there is none)
+  unsigned int next(unsigned int x) const;
+  size_t bytes() const;
+};
+
+#endif//__FM_INDEX_HPP__
@@ -0,0 +1,268 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// inputDecoder.cpp
+// streaming decoding of (possibly compressed) input in a separate thread
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2011 Hideo Bannai
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "inputDecoder.hpp"
+#include "trace.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+using namespace std;
+
+static const size_t INPUT_CHUNK = 1 << 20;
+
+////////////////////////////////////////////////////////////////////////////////
+
+DataBlock::DataBlock(size_t headroom_, size_t capacity_)
+  : size(0), headroom(headroom_), capacity(capacity_)
+{
+  base = static_cast<char *>(malloc(headroom + capacity));
+  data = base + headroom;
+}
+
+DataBlock::~DataBlock(){
+  free(base);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+InputDecoder::InputDecoder(size_t blockSize_, size_t headroom_, size_t depth)
+  : fd(-1), comp(COMP_NONE), blockSize(blockSize_), headroom(headroom_),
+    queue(depth), running(false), stopping(0)
+{};
+
+InputDecoder::~InputDecoder(){
+  if(running){
+    DataBlock * b;
+    __atomic_store_n(&stopping, 1, __ATOMIC_RELEASE);
+    while((b = queue.pop()) != NULL) delete b;
+    pthread_join(thread, NULL);
+  }
+  if(fd > 0) close(fd);
+}
+
+enum COMPRESSION InputDecoder::detect(const unsigned char * p, size_t n){
+  if(n >= 2 && p[0] == 0x1f && p[1] == 0x8b) return COMP_GZIP;
+  if(n >= 4 && p[0] == 0x28 && p[1] == 0xb5 && p[2] == 0x2f && p[3] == 0xfd) return COMP_ZSTD;
+  return COMP_NONE;
+}
+
+bool InputDecoder::supported(enum COMPRESSION c){
+  switch(c){
+  case COMP_NONE: return true;
+#ifdef HAVE_ZLIB
+  case COMP_GZIP: return true;
+#endif
+#ifdef HAVE_ZSTD
+  case COMP_ZSTD: return true;
+#endif
+  default: return false;
+  }
+}
+
+const char * InputDecoder::name(enum COMPRESSION c){
+  switch(c){
+  case COMP_GZIP: return "gzip";
+  case COMP_ZSTD: return "zstd";
+  default: return "none";
+  }
+}
+
+bool InputDecoder::start(const char * path){
+  fd = (strcmp(path, "-") == 0) ? 0 : open(path, O_RDONLY);
+  if(fd < 0){
+    err = string(path) + ": " + strerror(errno);
+    return false;
+  }
+  if(pthread_create(&thread, NULL, threadMain, this) != 0){
+    err = "could not start decoder thread";
+    return false;
+  }
+  running = true;
+  return true;
+}
+
+DataBlock * InputDecoder::next(){
+  if(!running) return NULL;
+  DataBlock * b = queue.pop();
+  if(b == NULL){
+    pthread_join(thread, NULL);
+    running = false;
+  }
+  return b;
+}
+
+void * InputDecoder::threadMain(void * arg){
+  static_cast<InputDecoder *>(arg)->decode();
+  return NULL;
+}
+
+// read until buf is full or the end of input. false on read error.
+bool InputDecoder::readInput(unsigned char * buf, size_t cap, size_t & n){
+  TraceSpan span("read");
+  ssize_t r;
+  n = 0;
+  while(n < cap && (r = read(fd, buf + n, cap - n)) != 0){
+    if(r < 0){
+      if(errno == EINTR) continue;
+      err = strerror(errno);
+      return false;
+    }
+    n += r;
+  }
+  return true;
+}
+
+void InputDecoder::decode(){
+  unsigned char * in = new unsigned char[INPUT_CHUNK];
+  size_t n;
+  Trace::setThreadName("decoder");
+  if(readInput(in, INPUT_CHUNK, n)){
+    comp = detect(in, n);
+    if(!supported(comp)){
+      err = string(name(comp)) + " input is not supported by this build";
+    } else {
+      switch(comp){
+      case COMP_GZIP: decodeGzip(in, n); break;
+      case COMP_ZSTD: decodeZstd(in, n); break;
+      default: decodeNone(in, n); break;
+      }
+    }
+  }
+  delete [] in;
+  queue.push(NULL);
+}
+
+// uncompressed input is read straight into the blocks
+void InputDecoder::decodeNone(unsigned char * in, size_t n){
+  DataBlock * blk = new DataBlock(headroom, blockSize > n ? blockSize : n);
+  memcpy(blk->data, in, n);
+  blk->size = n;
+  while(n > 0 && !__atomic_load_n(&stopping, __ATOMIC_ACQUIRE)){
+    if(!readInput(reinterpret_cast<unsigned char *>(blk->data) + blk->size,
+		  blk->capacity - blk->size, n)) break;
+    blk->size += n;
+    if(blk->size == blk->capacity){
+      queue.push(blk);
+      blk = new DataBlock(headroom, blockSize);
+    }
+  }
+  if(blk->size > 0 && err.empty()) queue.push(blk); else delete blk;
+}
+
+void InputDecoder::decodeGzip(unsigned char * in, size_t n){
+#ifdef HAVE_ZLIB
+  z_stream zs;
+  memset(&zs, 0, sizeof(zs));
+  if(inflateInit2(&zs, 15 + 32) != Z_OK){   // +32: gzip or zlib header
+    err = "inflateInit failed";
+    return;
+  }
+  DataBlock * blk = new DataBlock(headroom, blockSize);
+  bool inMember = true, outFull = false;
+  zs.next_in = in;
+  zs.avail_in = n;
+  while(!__atomic_load_n(&stopping, __ATOMIC_ACQUIRE)){
+    if(zs.avail_in == 0 && !outFull){
+      if(!readInput(in, INPUT_CHUNK, n)) break;
+      if(n == 0){
+	if(inMember) err = "truncated gzip input";
+	break;
+      }
+      zs.next_in = in;
+      zs.avail_in = n;
+    }
+    zs.next_out = reinterpret_cast<unsigned char *>(blk->data) + blk->size;
+    zs.avail_out = blk->capacity - blk->size;
+    if(zs.avail_in > 0) inMember = true;
+    TraceSpan span("inflate");
+    int r = inflate(&zs, Z_NO_FLUSH);
+    span.end();
+    outFull = (zs.avail_out == 0);
+    blk->size = blk->capacity - zs.avail_out;
+    if(r == Z_STREAM_END){             // concatenated members follow
+      inMember = false;
+      inflateReset(&zs);
+    } else if(r != Z_OK && r != Z_BUF_ERROR){
+      err = string("gzip: ") + (zs.msg ? zs.msg : "corrupt input");
+      break;
+    }
+    if(outFull){
+      queue.push(blk);
+      blk = new DataBlock(headroom, blockSize);
+    }
+  }
+  inflateEnd(&zs);
+  if(blk->size > 0 && err.empty()) queue.push(blk); else delete blk;
+#else
+  (void) in; (void) n;
+#endif
+}
+
+void InputDecoder::decodeZstd(unsigned char * in, size_t n){
+#ifdef HAVE_ZSTD
+  ZSTD_DCtx * dctx = ZSTD_createDCtx();
+  DataBlock * blk = new DataBlock(headroom, blockSize);
+  ZSTD_inBuffer zin = { in, n, 0 };
+  size_t ret = 1;                       // 0 when a frame is complete
+  bool outFull = false;
+  while(!__atomic_load_n(&stopping, __ATOMIC_ACQUIRE)){
+    if(zin.pos == zin.size && !outFull){
+      if(!readInput(in, INPUT_CHUNK, n)) break;
+      if(n == 0){
+	if(ret != 0) err = "truncated zstd input";
+	break;
+      }
+      zin.src = in;
+      zin.size = n;
+      zin.pos = 0;
+    }
+    ZSTD_outBuffer zout = { blk->data, blk->capacity, blk->size };
+    TraceSpan span("decompress");
+    ret = ZSTD_decompressStream(dctx, &zout, &zin);
+    span.end();
+    if(ZSTD_isError(ret)){
+      err = string("zstd: ") + ZSTD_getErrorName(ret);
+      break;
+    }
+    blk->size = zout.pos;
+    outFull = (zout.pos == zout.size);
+    if(outFull){
+      queue.push(blk);
+      blk = new DataBlock(headroom, blockSize);
+    }
+  }
+  ZSTD_freeDCtx(dctx);
+  if(blk->size > 0 && err.empty()) queue.push(blk); else delete blk;
+#else
+  (void) in; (void) n;
+#endif
+}
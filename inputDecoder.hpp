@@ -0,0 +1,94 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// inputDecoder.hpp
+// streaming decoding of (possibly compressed) input in a separate thread
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2011 Hideo Bannai
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __INPUT_DECODER_HPP__
+#define __INPUT_DECODER_HPP__
+
+#include <cstddef>
+#include <string>
+#include <pthread.h>
+#include "spscQueue.hpp"
+
+// gzip support requires HAVE_ZLIB, zstd support requires HAVE_ZSTD
+enum COMPRESSION {
+  COMP_NONE,
+  COMP_GZIP,   // gzip or zlib stream (concatenated members are decoded)
+  COMP_ZSTD,   // zstd frames
+};
+
+// a block of decoded bytes at data[0..size).
+// there are headroom writable bytes before data, so that a consumer can
+// prepend a little data without copying the block.
+class DataBlock {
+  char * base;
+  DataBlock(const DataBlock &);
+  DataBlock & operator=(const DataBlock &);
+public:
+  char * data;
+  size_t size;
+  size_t headroom;
+  size_t capacity;                      // bytes available at data
+  DataBlock(size_t headroom_, size_t capacity_);
+  ~DataBlock();
+};
+
+// decodes a file block by block in its own thread.
+// the blocks are handed over through a bounded queue, so decoding
+// runs ahead of the consumer by at most a few blocks.
+class InputDecoder {
+  int fd;
+  enum COMPRESSION comp;
+  size_t blockSize, headroom;
+  SPSCQueue<DataBlock> queue;
+  pthread_t thread;
+  bool running;
+  int stopping;                         // set when the consumer gives up
+  std::string err;                      // written by the decoder thread
+  static void * threadMain(void * arg);
+  void decode();
+  bool readInput(unsigned char * buf, size_t cap, size_t & n);
+  void decodeNone(unsigned char * in, size_t n);
+  void decodeGzip(unsigned char * in, size_t n);
+  void decodeZstd(unsigned char * in, size_t n);
+  InputDecoder(const InputDecoder &);
+  InputDecoder & operator=(const InputDecoder &);
+public:
+  InputDecoder(size_t blockSize_ = 1 << 22, size_t headroom_ = 1 << 16, size_t depth = 4);
+  ~InputDecoder();
+  // guess the compression of data beginning with p[0..n)
+  static enum COMPRESSION detect(const unsigned char * p, size_t n);
+  // true if this build can decode c
+  static bool supported(enum COMPRESSION c);
+  static const char * name(enum COMPRESSION c);
+  // open path ("-" for stdin) and start decoding.
+  // returns false if the file cannot be opened (see error()).
+  bool start(const char * path);
+  // the next decoded block, which the caller then owns.
+  // returns NULL at the end of input, or on error (error() is non-empty).
+  DataBlock * next();
+  // compression detected (valid after the first call of next)
+  enum COMPRESSION compression() const { return comp; }
+  const std::string & error() const { return err; }
+};
+
+#endif//__INPUT_DECODER_HPP__
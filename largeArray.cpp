@@ -0,0 +1,116 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// largeArray.cpp
+// huge page and numa placement of the pages of large arrays
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2011 Hideo Bannai
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "largeArray.hpp"
+#include <cstring>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+using namespace std;
+
+// numa policies of mbind(2) and get_mempolicy(2), called by syscall so
+// that libnuma is not needed
+static const int NUMA_PREFERRED = 1;    // with no nodes: the local node
+static const int NUMA_INTERLEAVE = 3;
+static const unsigned long NUMA_MF_MOVE = 1 << 1;
+static const unsigned long NUMA_F_MEMS_ALLOWED = 1 << 2;
+static const unsigned long NUMA_MAX_NODES = 1024;
+
+const size_t LargeArray::MIN_BYTES;
+
+// the flags in the order they are named
+static const unsigned int ALLOC_FLAGS[] = { ALLOC_HUGEPAGE, ALLOC_INTERLEAVE, ALLOC_LOCAL };
+static const char * ALLOC_NAMES[] = { "hugepage", "interleave", "local" };
+static const unsigned int NUM_ALLOC_FLAGS = sizeof(ALLOC_FLAGS) / sizeof(ALLOC_FLAGS[0]);
+
+string LargeArray::name(unsigned int f){
+  string s;
+  for(unsigned int i = 0; i < NUM_ALLOC_FLAGS; i++){
+    if(!(f & ALLOC_FLAGS[i])) continue;
+    if(!s.empty()) s += ",";
+    s += ALLOC_NAMES[i];
+  }
+  return s.empty() ? "default" : s;
+}
+
+bool LargeArray::parse(const char * s, unsigned int & f){
+  unsigned int r = 0, i;
+  if(strcmp(s, "default") == 0){
+    f = 0;
+    return true;
+  }
+  while(true){
+    const char * e = strchr(s, ',');
+    size_t len = e ? (size_t) (e - s) : strlen(s);
+    for(i = 0; i < NUM_ALLOC_FLAGS; i++){
+      if(strlen(ALLOC_NAMES[i]) == len && strncmp(s, ALLOC_NAMES[i], len) == 0) break;
+    }
+    if(i == NUM_ALLOC_FLAGS) return false;
+    r |= ALLOC_FLAGS[i];
+    if(e == NULL) break;
+    s = e + 1;
+  }
+  if((r & ALLOC_INTERLEAVE) && (r & ALLOC_LOCAL)) return false;
+  f = r;
+  return true;
+}
+
+bool LargeArray::place(void * p, size_t bytes, unsigned int flags){
+#ifdef __linux__
+  size_t page = sysconf(_SC_PAGESIZE);
+  size_t b = (reinterpret_cast<size_t>(p) + page - 1) & ~(page - 1);
+  size_t e = (reinterpret_cast<size_t>(p) + bytes) & ~(page - 1);
+  void * start = reinterpret_cast<void *>(b);
+  bool ok = true;
+  if(e <= b) return true;
+#ifdef MADV_HUGEPAGE
+  if((flags & ALLOC_HUGEPAGE) && madvise(start, e - b, MADV_HUGEPAGE) != 0) ok = false;
+#else
+  if(flags & ALLOC_HUGEPAGE) ok = false;
+#endif
+#if defined(SYS_mbind) && defined(SYS_get_mempolicy)
+  if(flags & ALLOC_INTERLEAVE){
+    unsigned long nodes[NUMA_MAX_NODES / (8 * sizeof(unsigned long))];
+    int mode;
+    memset(nodes, 0, sizeof(nodes));
+    if(syscall(SYS_get_mempolicy, &mode, nodes, NUMA_MAX_NODES, NULL, NUMA_F_MEMS_ALLOWED) != 0
+       || syscall(SYS_mbind, start, e - b, NUMA_INTERLEAVE, nodes, NUMA_MAX_NODES, NUMA_MF_MOVE) != 0){
+      ok = false;
+    }
+  }
+  if((flags & ALLOC_LOCAL)
+     && syscall(SYS_mbind, start, e - b, NUMA_PREFERRED, NULL, 0, NUMA_MF_MOVE) != 0){
+    ok = false;
+  }
+#else
+  if(flags & (ALLOC_INTERLEAVE | ALLOC_LOCAL)) ok = false;
+#endif
+  return ok;
+#else
+  (void) p; (void) bytes;
+  return flags == 0;
+#endif
+}
@@ -0,0 +1,72 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// largeArray.hpp
+// huge page and numa placement of the pages of large arrays
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2011 Hideo Bannai
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __LARGE_ARRAY_HPP__
+#define __LARGE_ARRAY_HPP__
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// placement of the pages of large arrays (a set of these flags, 0 for the
+// default of the system)
+enum ALLOCFLAG {
+  ALLOC_HUGEPAGE   = 1,  // transparent huge pages (madvise MADV_HUGEPAGE)
+  ALLOC_INTERLEAVE = 2,  // pages interleaved over the allowed numa nodes
+  ALLOC_LOCAL      = 4   // pages bound to the numa node of the allocating thread
+};
+
+// the suffix, rank, lcp and lpf arrays and the like are allocated through
+// LargeArray::assign, which applies a placement policy to their pages
+// before they are touched. the policy is given with each call (see
+// RunOptions::alloc), and only arrays of at least MIN_BYTES are placed. it is a hint: where the system does not
+// support it (not linux, no numa, transparent huge pages disabled) the
+// arrays are allocated as usual.
+class LargeArray {
+public:
+  static const size_t MIN_BYTES = 1 << 21;
+  // names of the flags of f separated by ',' ("default" for 0), as accepted by parse
+  static std::string name(unsigned int f);
+  // parse "default" or a list of "hugepage", "interleave", "local" separated by ','.
+  // interleave and local may not be combined. returns false if s is not valid.
+  static bool parse(const char * s, unsigned int & f);
+  // apply the policy f to the pages that lie inside [p, p+bytes).
+  // returns false if some part of the policy could not be applied.
+  static bool place(void * p, size_t bytes, unsigned int f);
+  // v = n value initialized elements (the old contents are discarded),
+  // with the pages of the new array placed by the policy f.
+  template <class T, class A>
+  static void assign(std::vector<T, A> & v, size_t n, unsigned int f){
+    if(f == 0 || n * sizeof(T) < MIN_BYTES){
+      v.assign(n, T());
+      return;
+    }
+    std::vector<T, A>(v.get_allocator()).swap(v);
+    v.reserve(n);
+    v.push_back(T());                    // touches only the first page
+    place(&v[0], n * sizeof(T), f);
+    v.resize(n);
+  }
+};
+
+#endif//__LARGE_ARRAY_HPP__
@@ -28,12 +28,27 @@
 
 #include "lz77.hpp"
 #include "suffixArray.hpp"
+#include "divsufsort.h"
+#include "fmIndex.hpp"
+#include "largeArray.hpp"
+#include "packedDna.hpp"
+#include <algorithm>
+#include <pthread.h>
+#include <unistd.h>
 
 using namespace std;
 
+// length of the longest common prefix of str[i..n) and str[j..n),
+// knowing that it is at least l. dna is the packed text, or NULL.
+template <class T>
+static unsigned int lce(const T * str, const PackedDNA * dna, unsigned int n,
+			unsigned int i, unsigned int j, unsigned int l = 0){
+  unsigned int m = n - max(i, j);
+  return (l < m) ? l + dnaLce(str, dna, i + l, j + l, m - l) : l;
+}
+
 // linear time computation of s/lz-factorization using suffix and lcp arrays.
-// my original two-pass version.
-// there seem to be some algorithms that do it in one pass
+// my original two-pass version, now in one pass.
 // -----------------------------------------------------------------------
 // Description of algorithm:
 // for any given position i in suffix array, let
@@ -42,60 +57,58 @@ using namespace std;
 // the longest factor starting at i that appears
 // in a previous position in text begins at positions
 // either l or r, with length LCP(sa[l],sa[i]) or
-// LCP(sa[r],sa[i]), whichever is longer. 
-// For each position, the algorithm calculates l and r in each pass.
+// LCP(sa[r],sa[i]), whichever is longer (l if they are the same).
+// both are found with one stack: an element popped by i has r = i, and
+// l is the element below it.
 // -----------------------------------------------------------------------
-static void LPF_original(const SuffixArrayAux & SAaux, 
-			 vector<unsigned int> & POS,
-			 vector<unsigned int> & LEN){
-  unsigned int i, l, length = SAaux.size();
-  const int * sa = SAaux.getSA();
-  const std::vector<uInt> & LCP  = SAaux.getLCP();
-  vector<pair<unsigned int, unsigned int> > S;
+// the arrays are reused: on entry POS holds the rank array, which is not
+// needed, and LEN the lcp array. POS[sa[i]] is written when i is popped,
+// and sa is then freed. the lengths are computed afterwards in text order
+// over the lcp array, which is no longer needed: LEN[i] is the lce of i
+// and POS[i], and at least LEN[i-1]-1, so this takes linear time as in
+// the lcp computation of Kasai et al.
+// so the memory does not grow beyond that of the suffix, rank and lcp
+// arrays, besides the stack.
+template <class T>
+static void LPF_original(const T * str, const PackedDNA * dna,
+			 UIntArray & SA,
+			 UIntArray & POS,
+			 UIntArray & LEN,
+			 RunStats * stats){
+  unsigned int i, x, l, lp, length = SA.size();
+  ResourceVector<pair<unsigned int, unsigned int> >::type S;
   pair<unsigned int, unsigned int> p;
   
-  // for each position i, find largest i' < i with sa[i'] < sa[i]
   // the stack(vector) represents positions in increasing order.
   // first  elm: indices of positions
   // second elm: the lcp value to the previous element in stack.
-  for(i = 0; i < length; i++){
-    l = LCP[i];
-    while(!S.empty() && sa[S.back().first] > sa[i]){ // pop while new element is smaller
-      l = std::min(l, S.back().second); S.pop_back();
-    }
-    if(!S.empty() && l > 0){
-      POS[sa[i]] = sa[S.back().first];
-      LEN[sa[i]] = l;
-    } else {
-      POS[sa[i]] = sa[i];
-      LEN[sa[i]] = 0;
+  for(i = 0; i <= length; i++){
+    l = (i < length) ? LEN[i] : 0;       // i == length pops the rest, which have no r
+    while(!S.empty() && (i == length || SA[S.back().first] > SA[i])){ // pop while new element is smaller
+      x = S.back().first;
+      lp = S.back().second;
+      S.pop_back();
+      if(l > lp || S.empty()){           // r, or neither
+	POS[SA[x]] = (l > 0) ? SA[i] : SA[x];
+      } else {                           // l, or neither
+	POS[SA[x]] = (lp > 0) ? SA[S.back().first] : SA[x];
+      }
+      l = std::min(l, lp);
     }
+    if(i == length) break;
     p.first = i;
     p.second = l;
     S.push_back(p);
   }
+  if(stats) stats->arrayBytes[STAGE_LPF] += S.capacity() * sizeof(p);
+  freeVector(SA);
 
-		       
-  // for each position i, find smallest i' > i with sa[i'] < sa[i]
-  // the stack(vector) represents positions in increasing order.
-  // first  elm: indices of positions
-  // second elm: the lcp value to the next element in stack.
-  S.clear();
-  for(i = length; i-- > 0;){
-    while(!S.empty() && sa[S.back().first] > sa[i]){
-      p = S.back();
-      l = p.second; S.pop_back();
-      if(!S.empty()) S.back().second = min(l, S.back().second); 
-    }
-    if((!S.empty()) && ((l = S.back().second) > LEN[sa[i]])){
-      POS[sa[i]] = sa[S.back().first];
-      LEN[sa[i]] = l;
-    }
-    p.first = i;
-    p.second = LCP[i];
-    S.push_back(p);
+  for(i = 0, l = 0; i < length; i++){   // lengths in text order
+    l = (POS[i] == i) ? 0 : lce(str, dna, length, i, POS[i], l);
+    LEN[i] = l;
+    if(l > 0) l--;
   }
-  
+
   // assure left most // this isn't actuall needed.
   for(i = 1; i < length; i++){
     if(LEN[i] > 0 && LEN[POS[i]] >= LEN[i])
@@ -103,16 +116,703 @@ static void LPF_original(const SuffixArrayAux & SAaux,
   }
 }
 
+// PSV and NSV over the suffix array, for each text position: for the
+// suffix i of rank r, the psv is sa[j] for the largest j < r with
+// sa[j] < i, and the nsv is sa[j] for the smallest j > r with sa[j] < i
+// (n if there is none). the longest previous factor at i begins at one of
+// them, as in LPF_original. they are stored interleaved in pnsv[2i] and
+// pnsv[2i+1] (placed by policy alloc). the stack of the scan is kept in
+// the part of sa already read, so sa is destroyed.
+// see: J. Karkkainen, D. Kempa and S. J. Puglisi,
+// Linear Time Lempel-Ziv Factorization: Simple, Fast, Small. CPM 2013: 189-200
+static void psvNsv(int * sa, unsigned int n, UIntArray & pnsv, unsigned int alloc){
+  unsigned int j, cur, top = 0;         // the stack is sa[0..top), top <= j
+  LargeArray::assign(pnsv, 2 * (size_t) n, alloc);
+  for(j = 0; j < n; j++){
+    cur = sa[j];
+    while(top > 0 && (unsigned int) sa[top-1] > cur){
+      pnsv[2 * (size_t) sa[--top] + 1] = cur;
+    }
+    pnsv[2 * (size_t) cur] = (top > 0) ? sa[top-1] : n;
+    sa[top++] = cur;
+  }
+  while(top > 0) pnsv[2 * (size_t) sa[--top] + 1] = n;
+}
+
+// factorize by comparing each factor with its psv and nsv candidates.
+// the comparisons take time linear in the factor lengths, so O(n) in total.
+template <class T>
+static void LZ_kkp(const T * str, const PackedDNA * dna, unsigned int n,
+		   LZFactors & factors, RunStats * stats, const RunOptions & opts){
+  UIntArray pnsv;
+  {
+    StageTimer sort(stats, STAGE_SUFFIX_SORT);
+    ResourceVector<int>::type sa;
+    LargeArray::assign(sa, n, opts.alloc);
+    if(n > 0) BasicSuffixArray<T>::sort(str, &sa[0], n, opts);
+    sort.stop();
+    StageTimer timer(stats, STAGE_LPF);
+    psvNsv(n > 0 ? &sa[0] : NULL, n, pnsv, opts.alloc);
+    freeVector(sa);
+    if(stats){
+      stats->arrayBytes[STAGE_SUFFIX_SORT] += n * sizeof(int);
+      stats->arrayBytes[STAGE_LPF] += pnsv.capacity() * sizeof(unsigned int);
+    }
+  }
+  StageTimer timer(stats, STAGE_LPF);
+  for(unsigned int i = 0; i < n;){
+    unsigned int p = pnsv[2 * (size_t) i], q = pnsv[2 * (size_t) i + 1];
+    unsigned int lp = (p < n) ? lce(str, dna, n, p, i) : 0;
+    unsigned int lq = (q < n) ? lce(str, dna, n, q, i) : 0;
+    if(lq > lp){ p = q; lp = lq; }
+    if(lp == 0){
+      factors.push_back(LZFactor(i, 0, i));
+      i++;
+    } else {
+      factors.push_back(LZFactor(i, lp, p));
+      i += lp;
+    }
+  }
+}
+
+// lpf of positions from..to-1, given the psv in POS[i] and the nsv in
+// LEN[i] as text positions (n: none). of two candidates of the same
+// length, the psv is taken, as in LPF_original. since
+//   lcp(i, psv[i]) >= lcp(i-1, psv[i-1]) - 1
+// (the same for nsv), the comparisons take O(to - from + n) time at most,
+// as for the lcp array, and usually O(to - from).
+template <class T>
+static void lpfSweep(const T * str, const PackedDNA * dna, unsigned int n,
+		     unsigned int * POS, unsigned int * LEN,
+		     unsigned int from, unsigned int to){
+  unsigned int i, p, q, lp = 0, lq = 0;
+  for(i = from; i < to; i++){
+    p = POS[i]; q = LEN[i];
+    lp = (p < n) ? lce(str, dna, n, p, i, lp ? lp - 1 : 0) : 0;
+    lq = (q < n) ? lce(str, dna, n, q, i, lq ? lq - 1 : 0) : 0;
+    if(lq > lp){
+      POS[i] = q; LEN[i] = lq;
+    } else if(lp > 0){
+      POS[i] = p; LEN[i] = lp;
+    } else {
+      POS[i] = i; LEN[i] = 0;
+    }
+  }
+}
+
+// single pass lpf from psv and nsv computed in place by peak elimination.
+// the suffix array is turned into a doubly linked list of text positions
+// in lexicographic order (PREV in POS, over the suffix array, and NEXT in
+// LEN). removing the positions from n-1 down to 0, the position removed
+// is the largest in the list, so its neighbors are its psv and nsv, and
+// they are left in its own PREV and NEXT entries. the lpf is then computed
+// in one sweep in text order (lpfSweep). no stacks, rank or lcp arrays,
+// and no pass chasing POS[POS[i]].
+// see: K. Goto and H. Bannai, Simpler and Faster Lempel Ziv Factorization.
+// DCC 2013: 133-142
+template <class T>
+static void LPF_peak(const T * str, const PackedDNA * dna, unsigned int n,
+		     UIntArray & POS,
+		     UIntArray & LEN,
+		     RunStats * stats, const RunOptions & opts){
+  unsigned int i, p, q;
+  LargeArray::assign(POS, n, opts.alloc);
+  LargeArray::assign(LEN, n, opts.alloc);
+  if(stats){
+    stats->arrayBytes[STAGE_SUFFIX_SORT] += POS.capacity() * sizeof(unsigned int);
+    stats->arrayBytes[STAGE_LPF] += LEN.capacity() * sizeof(unsigned int);
+  }
+  if(n == 0) return;
+  StageTimer sort(stats, STAGE_SUFFIX_SORT);
+  int * sa = reinterpret_cast<int *>(&POS[0]);
+  BasicSuffixArray<T>::sort(str, sa, n, opts);
+  sort.stop();
+  StageTimer timer(stats, STAGE_LPF);
+  unsigned int first = sa[0];
+  for(i = 0; i + 1 < n; i++) LEN[sa[i]] = sa[i+1];
+  LEN[sa[n-1]] = n;
+  for(i = 0; i < n; i++){                // sa is not needed any more
+    if(LEN[i] < n) POS[LEN[i]] = i;
+  }
+  POS[first] = n;
+  for(i = n; i-- > 0;){                  // peak elimination
+    p = POS[i]; q = LEN[i];
+    if(p < n) LEN[p] = q;
+    if(q < n) POS[q] = p;
+  }
+  lpfSweep(str, dna, n, &POS[0], &LEN[0], 0, n);
+}
+
+// factorize in compressed space with an FM-index of the reversed text.
+// s[i..i+l) occurs ending at e iff its reverse is a prefix of the suffix
+// of the reversed text for the prefix s[0..e], so the rows of a pattern
+// extended to the right are found by backward search. an occurrence
+// begins before i iff it ends before i+l-1, so the factor is extended
+// while the rows of the pattern contain the row of some prefix of length
+// at most i+l; these rows are added to a successor set as the prefixes
+// grow, walking the index with lf.
+// besides the text, the index and the set take about
+// log(sigma) + 2 + 1 bits per character (with suffix array samples every
+// 32 positions), but divbwt needs about 6n bytes while building it.
+// see: S. Kreft and G. Navarro, On Compressing and Indexing Repetitive
+// Sequences. Theoretical Computer Science 483: 115-133 (2013)
+static void LZ_fm(const unsigned char * str, unsigned int n,
+		  LZFactors & factors, RunStats * stats){
+  if(n == 0) return;
+  StageTimer sort(stats, STAGE_SUFFIX_SORT);
+  ResourceVector<unsigned char>::type rev(str, str + n);
+  reverse(rev.begin(), rev.end());
+  FMIndex fm(&rev[0], n);
+  freeVector(rev);
+  sort.stop();
+  StageTimer timer(stats, STAGE_LPF);
+  SuccessorSet prefixes(fm.rows());
+  unsigned int i, l, lo, hi, nlo, nhi, x, found = 0;
+  unsigned int t = 0, r = 0;             // rows of the prefixes of length <= t are in prefixes,
+                                         // r is that of length t
+  for(i = 0; i < n;){
+    lo = 0; hi = fm.rows();
+    for(l = 0; i + l < n; l++){
+      nlo = lo; nhi = hi;
+      if(!fm.extend(str[i+l], nlo, nhi)) break;
+      while(t < i + l){
+	r = fm.lf(r);
+	prefixes.insert(r);
+	t++;
+      }
+      if((x = prefixes.next(nlo)) >= nhi) break;
+      lo = nlo; hi = nhi; found = x;
+    }
+    if(l == 0){
+      factors.push_back(LZFactor(i, 0, i));
+      i++;
+    } else {
+      unsigned int e = n - 1 - fm.locate(found);   // s[i..i+l) = s[e-l+1..e]
+      factors.push_back(LZFactor(i, l, e + 1 - l));
+      i += l;
+    }
+  }
+  if(stats){
+    stats->arrayBytes[STAGE_SUFFIX_SORT] += 2 * n + (n + 1) * sizeof(int);  // reversed text, bwt, divbwt
+    stats->arrayBytes[STAGE_LPF] += fm.bytes() + prefixes.bytes();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// parallel lpf, with the same result as LPF_original.
+// the suffix array is split into one block per thread:
+//   PHASE_LOCAL:    psv and nsv (as indices of sa) within each block with a
+//                   stack. those not found in the block are the prefix
+//                   (suffix) minima of the block.
+//   PHASE_RESOLVE:  the psv of the prefix minima of a block, in decreasing
+//                   order, by following the psv of the blocks to the left,
+//                   jumping over a whole block at a prefix minimum. the same
+//                   for the nsv to the right. only values of PHASE_LOCAL are
+//                   read, so the blocks are independent.
+//   PHASE_SCATTER:  psv and nsv as text positions to POS and LEN.
+// then the text is split into one chunk per thread:
+//   PHASE_SWEEP:    lpfSweep of each chunk.
+//   PHASE_LEFTMOST: the "assure left most" pass of LPF_original, where
+//                   POS[i] = POS[POS[i]] with the final value of POS[POS[i]].
+//                   when POS[i] is in an earlier chunk, POS[i] is marked as a
+//                   reference to it,
+//   PHASE_LINK:     and the references are followed (at most one per chunk).
+// see: J. Shun and K. Zhao, Practical Parallel Lempel-Ziv Factorization.
+// DCC 2013: 123-132
+////////////////////////////////////////////////////////////////////////////////
+
+enum LPF_PHASE { PHASE_LOCAL, PHASE_RESOLVE, PHASE_SCATTER, PHASE_SWEEP,
+		 PHASE_LEFTMOST, PHASE_LINK };
+
+static const unsigned int UNRESOLVED = 0xffffffffu;  // not found in the block
+static const unsigned int REF = 0x80000000u;         // POS[i] refers to POS[POS[i] & ~REF]
+
+// data shared by the threads of LPF_parallel
+class ParallelLPF {
+public:
+  const void * str;                    // of symbol type T of
+  void (*sweep)(ParallelLPF * w, unsigned int b, unsigned int e);  // sweepChunk<T>
+  const PackedDNA * dna;
+  unsigned int n, nt;
+  const int * sa;
+  UIntArray psv, nsv;                  // indices of sa (n: none)
+  unsigned int * POS, * LEN;
+  enum LPF_PHASE phase;
+  // beginning of block or chunk t
+  unsigned int bound(unsigned int t) const {
+    return (unsigned int) ((unsigned long long) n * t / nt);
+  }
+};
+
+class ParallelLPFTask {
+public:
+  ParallelLPF * w;
+  unsigned int id;
+  // resolved (index, psv or nsv). they are filled by the threads, so they
+  // come from the heap rather than the (single threaded) current resource.
+  vector<pair<unsigned int, unsigned int> > pres, nres;
+};
+
+static void localAnsv(ParallelLPF * w, unsigned int b, unsigned int e){
+  const int * sa = w->sa;
+  unsigned int j;
+  vector<unsigned int> S;               // in a thread: from the heap
+  for(j = b; j < e; j++){
+    while(!S.empty() && sa[S.back()] > sa[j]) S.pop_back();
+    w->psv[j] = S.empty() ? UNRESOLVED : S.back();
+    S.push_back(j);
+  }
+  S.clear();
+  for(j = e; j-- > b;){
+    while(!S.empty() && sa[S.back()] > sa[j]) S.pop_back();
+    w->nsv[j] = S.empty() ? UNRESOLVED : S.back();
+    S.push_back(j);
+  }
+}
+
+static void resolveAnsv(ParallelLPFTask * task){
+  ParallelLPF * w = task->w;
+  const int * sa = w->sa;
+  unsigned int j, k, kb, t = task->id, b = w->bound(t), e = w->bound(t+1);
+  // psv of the prefix minima, from left to right
+  kb = t;                                // block of k
+  k = b;                                 // k - 1 is the candidate
+  for(j = b; j < e; j++){
+    if(w->psv[j] != UNRESOLVED) continue;
+    while(k > 0 && sa[k-1] > sa[j]){
+      if(w->psv[k-1] != UNRESOLVED){
+	k = w->psv[k-1] + 1;
+      } else {
+	while(w->bound(kb) >= k) kb--;   // the block of k - 1
+	k = w->bound(kb);
+      }
+    }
+    task->pres.push_back(make_pair(j, k > 0 ? k - 1 : w->n));
+  }
+  // nsv of the suffix minima, from right to left
+  kb = t + 1;                            // block after k
+  k = e;                                 // k is the candidate
+  for(j = e; j-- > b;){
+    if(w->nsv[j] != UNRESOLVED) continue;
+    while(k < w->n && sa[k] > sa[j]){
+      if(w->nsv[k] != UNRESOLVED){
+	k = w->nsv[k];
+      } else {
+	while(w->bound(kb) <= k) kb++;   // the block after k
+	k = w->bound(kb);
+      }
+    }
+    task->nres.push_back(make_pair(j, k));
+  }
+}
+
+static void scatterAnsv(ParallelLPFTask * task){
+  ParallelLPF * w = task->w;
+  const int * sa = w->sa;
+  unsigned int r, j, n = w->n, b = w->bound(task->id), e = w->bound(task->id + 1);
+  for(r = 0; r < task->pres.size(); r++) w->psv[task->pres[r].first] = task->pres[r].second;
+  for(r = 0; r < task->nres.size(); r++) w->nsv[task->nres[r].first] = task->nres[r].second;
+  for(j = b; j < e; j++){
+    w->POS[sa[j]] = (w->psv[j] < n) ? sa[w->psv[j]] : n;
+    w->LEN[sa[j]] = (w->nsv[j] < n) ? sa[w->nsv[j]] : n;
+  }
+}
+
+template <class T>
+static void sweepChunk(ParallelLPF * w, unsigned int b, unsigned int e){
+  lpfSweep(static_cast<const T *>(w->str), w->dna, w->n, w->POS, w->LEN, b, e);
+}
+
+static void leftmost(ParallelLPF * w, unsigned int b, unsigned int e){
+  unsigned int i, p, * POS = w->POS, * LEN = w->LEN;
+  for(i = b; i < e; i++){
+    if(LEN[i] > 0 && LEN[POS[i]] >= LEN[i]){
+      p = POS[i];
+      POS[i] = (p >= b) ? POS[p] : (p | REF);
+    }
+  }
+}
+
+// the chunks are linked concurrently, so POS is accessed atomically
+static void linkLeftmost(ParallelLPF * w, unsigned int b, unsigned int e){
+  unsigned int i, p, x, last = UNRESOLVED, lastp = 0, * POS = w->POS;
+  for(i = b; i < e; i++){
+    p = __atomic_load_n(&POS[i], __ATOMIC_RELAXED);
+    if(!(p & REF)) continue;
+    x = p & ~REF;
+    if(x != last){
+      last = x;
+      do {
+	p = __atomic_load_n(&POS[x], __ATOMIC_RELAXED);
+	x = p & ~REF;
+      } while(p & REF);
+      lastp = p;
+    }
+    __atomic_store_n(&POS[i], lastp, __ATOMIC_RELAXED);
+  }
+}
+
+static void * parallelLPFThread(void * arg){
+  ParallelLPFTask * task = static_cast<ParallelLPFTask *>(arg);
+  ParallelLPF * w = task->w;
+  unsigned int b = w->bound(task->id), e = w->bound(task->id + 1);
+  switch(w->phase){
+  case PHASE_LOCAL:    localAnsv(w, b, e); break;
+  case PHASE_RESOLVE:  resolveAnsv(task); break;
+  case PHASE_SCATTER:  scatterAnsv(task); break;
+  case PHASE_SWEEP:    w->sweep(w, b, e); break;
+  case PHASE_LEFTMOST: leftmost(w, b, e); break;
+  case PHASE_LINK:     linkLeftmost(w, b, e); break;
+  }
+  return NULL;
+}
+
+// run phase on all threads, the first one being this thread.
+// tasks of threads that could not be created are run here too.
+static void runPhase(ParallelLPF & w, ResourceVector<ParallelLPFTask>::type & tasks,
+		     enum LPF_PHASE phase){
+  ResourceVector<pthread_t>::type th(tasks.size());
+  unsigned int t, started = 1;
+  TraceSpan span("lpf phase", phase);
+  w.phase = phase;
+  for(; started < tasks.size(); started++){
+    if(pthread_create(&th[started], NULL, parallelLPFThread, &tasks[started]) != 0) break;
+  }
+  for(t = started; t < tasks.size(); t++) parallelLPFThread(&tasks[t]);
+  parallelLPFThread(&tasks[0]);
+  for(t = 1; t < started; t++) pthread_join(th[t], NULL);
+}
+
+template <class T>
+static void LPF_parallel(const T * str, const PackedDNA * dna, unsigned int n,
+			 UIntArray & POS,
+			 UIntArray & LEN,
+			 RunStats * stats, const RunOptions & opts){
+  LargeArray::assign(POS, n, opts.alloc);
+  LargeArray::assign(LEN, n, opts.alloc);
+  if(n == 0) return;
+  ParallelLPF w;
+  unsigned int t, nt = opts.lzThreads;
+  if(nt == 0){                           // one per processor, with blocks of 64K at least
+    long np = sysconf(_SC_NPROCESSORS_ONLN);
+    nt = max(1u, min((unsigned int) (np > 0 ? np : 1), n >> 16));
+  }
+  nt = min(nt, n);
+  assert(n < REF);                      // longer texts are not sent here (see LZ77::lpf)
+  StageTimer sort(stats, STAGE_SUFFIX_SORT);
+  ResourceVector<int>::type sa;
+  LargeArray::assign(sa, n, opts.alloc);
+  BasicSuffixArray<T>::sort(str, &sa[0], n, opts);
+  sort.stop();
+  StageTimer timer(stats, STAGE_LPF);
+  w.str = str;
+  w.sweep = sweepChunk<T>;
+  w.dna = dna;
+  w.n = n;
+  w.nt = nt;
+  w.sa = &sa[0];
+  LargeArray::assign(w.psv, n, opts.alloc);
+  LargeArray::assign(w.nsv, n, opts.alloc);
+  w.POS = &POS[0];
+  w.LEN = &LEN[0];
+  ResourceVector<ParallelLPFTask>::type tasks(nt);
+  for(t = 0; t < nt; t++){
+    tasks[t].w = &w;
+    tasks[t].id = t;
+  }
+  runPhase(w, tasks, PHASE_LOCAL);
+  runPhase(w, tasks, PHASE_RESOLVE);
+  runPhase(w, tasks, PHASE_SCATTER);
+  if(stats){
+    stats->arrayBytes[STAGE_SUFFIX_SORT] += n * sizeof(int);
+    stats->arrayBytes[STAGE_LPF] += (w.psv.capacity() + w.nsv.capacity()
+				+ POS.capacity() + LEN.capacity()) * sizeof(unsigned int);
+  }
+  freeVector(sa);
+  freeVector(w.psv);
+  freeVector(w.nsv);
+  runPhase(w, tasks, PHASE_SWEEP);
+  runPhase(w, tasks, PHASE_LEFTMOST);
+  runPhase(w, tasks, PHASE_LINK);
+}
+
+const char * LZ77::name(enum ALGFLAG algf){
+  switch(algf){
+  case USE_LPF_ORIGINAL: return "original";
+  case USE_LZ_KKP:       return "kkp";
+  case USE_LPF_PEAK:     return "peak";
+  case USE_LZ_ONLINE:    return "online";
+  case USE_LPF_PARALLEL: return "parallel";
+  case USE_LZ_FM:        return "fm";
+  default:               return "unknown";
+  }
+}
+
+bool LZ77::parse(const char * name, enum ALGFLAG & algf){
+  for(unsigned int a = 0; a < NUM_ALGFLAGS; a++){
+    if(string(name) == LZ77::name(static_cast<enum ALGFLAG>(a))){
+      algf = static_cast<enum ALGFLAG>(a);
+      return true;
+    }
+  }
+  return false;
+}
+
 void LZ77::lpf(const std::string & str, 
-	       std::vector<unsigned int> & POS,
-	       std::vector<unsigned int> & LEN,
-	       enum ALGFLAG algf){
-  SuffixArrayAux SAaux(str);
-  POS = LEN = vector<unsigned int>(str.size(),0);
+	       UIntArray & POS,
+	       UIntArray & LEN,
+	       enum ALGFLAG algf, RunStats * stats, const PackedDNA * dna,
+	       const RunOptions & opts){
+  LZ77::lpf(reinterpret_cast<const unsigned char *>(str.data()), str.size(), POS, LEN, algf, stats, dna,
+	    opts);
+}
+
+template <class T>
+void LZ77::lpf(const T * str, unsigned int n,
+	       UIntArray & POS,
+	       UIntArray & LEN,
+	       enum ALGFLAG algf, RunStats * stats, const PackedDNA * dna,
+	       const RunOptions & opts){
+  if(algf == USE_LPF_PEAK){
+    LPF_peak(str, dna, n, POS, LEN, stats, opts);
+    return;
+  }
+  // positions of LPF_parallel are tagged with REF: longer texts fall back
+  // to LPF_original
+  if(algf == USE_LPF_PARALLEL && n < REF){
+    LPF_parallel(str, dna, n, POS, LEN, stats, opts);
+    return;
+  }
+  UIntArray SA;
+  {
+    BasicSuffixArray<T> SAaux(str, n, stats, opts);
+    SAaux.release(SA, POS, LEN);
+  }
+  StageTimer timer(stats, STAGE_LPF);
+  LPF_original(str, dna, SA, POS, LEN, stats);
+}
+
+// the engines of byte texts only. returns false if algf is not one.
+static bool factorizeBytes(const unsigned char * str, unsigned int n,
+			   LZFactors & factors,
+			   enum ALGFLAG algf, RunStats * stats){
   switch(algf){
-  case USE_LPF_ORIGINAL:
-    LPF_original(SAaux, POS, LEN); break;
+  case USE_LZ_FM:
+    LZ_fm(str, n, factors, stats);
+    return true;
+  case USE_LZ_ONLINE: {
+    StageTimer timer(stats, STAGE_LPF);
+    OnlineLZ77 olz;
+    olz.push(str, n, factors);
+    olz.finish(factors);
+    if(stats) stats->arrayBytes[STAGE_LPF] += olz.bytes();
+    return true;
+  }
   default:
-    assert(false);
+    return false;
+  }
+}
+
+// wider symbols: the fm index and the automaton have byte alphabets, and
+// LPF_original is used instead
+template <class T>
+static bool factorizeBytes(const T *, unsigned int, LZFactors &, enum ALGFLAG, RunStats *){
+  return false;
+}
+
+// the lz factors of the lpf arrays. they are counted first, so that the
+// vector is not copied while it grows (it may be as large as 12n).
+static void factorsOfLpf(const UIntArray & POS, const UIntArray & LEN, unsigned int n,
+			 LZFactors & factors){
+  unsigned int i, count = 0;
+  for(i = 0; i < n; i += max(1u, LEN[i])) count++;
+  factors.reserve(count);
+  for(i = 0; i < n; i += max(1u, LEN[i])) factors.push_back(LZFactor(i, LEN[i], POS[i]));
+}
+
+template <class T>
+void LZ77::factorize(const T * str, unsigned int n,
+		     LZFactors & factors,
+		     enum ALGFLAG algf, RunStats * stats, const PackedDNA * dna,
+		     const RunOptions & opts){
+  factors.clear();
+  if(factorizeBytes(str, n, factors, algf, stats)){
+    if(stats) stats->arrayBytes[STAGE_LPF] += factors.capacity() * sizeof(LZFactor);
+    return;
+  }
+  switch(algf){
+  case USE_LPF_ORIGINAL:
+  case USE_LPF_PEAK:
+  case USE_LPF_PARALLEL: {
+    UIntArray POS, LEN;
+    LZ77::lpf(str, n, POS, LEN, algf, stats, dna, opts);
+    factorsOfLpf(POS, LEN, n, factors);
+    break;
+  }
+  case USE_LZ_KKP:
+    LZ_kkp(str, dna, n, factors, stats, opts); break;
+  default: {
+    assert(sizeof(T) > 1 && (algf == USE_LZ_FM || algf == USE_LZ_ONLINE));
+    UIntArray POS, LEN;
+    LZ77::lpf(str, n, POS, LEN, USE_LPF_ORIGINAL, stats, dna, opts);
+    factorsOfLpf(POS, LEN, n, factors);
+    break;
   }
+  }
+  if(stats) stats->arrayBytes[STAGE_LPF] += factors.capacity() * sizeof(LZFactor);
+}
+
+// the symbol types of the texts
+template void LZ77::lpf(const unsigned char * str, unsigned int n, UIntArray & POS, UIntArray & LEN,
+			enum ALGFLAG algf, RunStats * stats, const PackedDNA * dna,
+			const RunOptions & opts);
+template void LZ77::factorize(const unsigned char * str, unsigned int n, LZFactors & factors,
+			      enum ALGFLAG algf, RunStats * stats, const PackedDNA * dna,
+			      const RunOptions & opts);
+template void LZ77::lpf(const unsigned short * str, unsigned int n, UIntArray & POS, UIntArray & LEN,
+			enum ALGFLAG algf, RunStats * stats, const PackedDNA * dna,
+			const RunOptions & opts);
+template void LZ77::factorize(const unsigned short * str, unsigned int n, LZFactors & factors,
+			      enum ALGFLAG algf, RunStats * stats, const PackedDNA * dna,
+			      const RunOptions & opts);
+template void LZ77::lpf(const unsigned int * str, unsigned int n, UIntArray & POS, UIntArray & LEN,
+			enum ALGFLAG algf, RunStats * stats, const PackedDNA * dna,
+			const RunOptions & opts);
+template void LZ77::factorize(const unsigned int * str, unsigned int n, LZFactors & factors,
+			      enum ALGFLAG algf, RunStats * stats, const PackedDNA * dna,
+			      const RunOptions & opts);
+
+////////////////////////////////////////////////////////////////////////////////
+
+const unsigned int OnlineLZ77::NONE;
+
+OnlineLZ77::OnlineLZ77()
+  : hashKey(1 << 10, ~0ULL), hashTo(1 << 10), hashShift(64 - 10), nedges(0),
+    last(0), cur(0), mlen(0), beg(0), pos(0)
+{
+  for(unsigned int c = 0; c < 256; c++) root[c] = NONE;
+  newState(0, NONE);
+  link[0] = NONE;
+}
+
+unsigned int OnlineLZ77::newState(unsigned int l, unsigned int f){
+  link.push_back(0);
+  len.push_back(l);
+  first.push_back(f);
+  head.push_back(NONE);
+  return len.size() - 1;
+}
+
+// slot of key, or of the empty slot where it would be inserted
+size_t OnlineLZ77::slot(unsigned long long key) const {
+  size_t h = (key * 0x9e3779b97f4a7c15ULL) >> hashShift, mask = hashKey.size() - 1;
+  while(hashKey[h] != key && hashKey[h] != ~0ULL) h = (h + 1) & mask;
+  return h;
+}
+
+// double the table
+void OnlineLZ77::rehash(){
+  ResourceVector<unsigned long long>::type keys(hashKey.size() * 2, ~0ULL, hashKey.get_allocator());
+  UIntArray to(keys.size(), 0, hashTo.get_allocator());
+  keys.swap(hashKey);
+  to.swap(hashTo);
+  hashShift--;
+  for(size_t i = 0; i < keys.size(); i++){
+    if(keys[i] == ~0ULL) continue;
+    size_t h = slot(keys[i]);
+    hashKey[h] = keys[i];
+    hashTo[h] = to[i];
+  }
+}
+
+unsigned int OnlineLZ77::next(unsigned int p, unsigned char c) const {
+  if(p == 0) return root[c];
+  size_t h = slot(((unsigned long long) p << 8) | c);
+  return (hashKey[h] == ~0ULL) ? NONE : hashTo[h];
+}
+
+void OnlineLZ77::setNext(unsigned int p, unsigned char c, unsigned int q){
+  if(p == 0){
+    root[c] = q;
+    return;
+  }
+  unsigned long long key = ((unsigned long long) p << 8) | c;
+  size_t h = slot(key);
+  if(hashKey[h] == ~0ULL){              // a new edge
+    if(2 * (nedges + 1) > hashKey.size()){
+      rehash();
+      h = slot(key);
+    }
+    hashKey[h] = key;
+    nedges++;
+    edgeChar.push_back(c);
+    edgeNext.push_back(head[p]);
+    head[p] = edgeChar.size() - 1;
+  }
+  hashTo[h] = q;
+}
+
+// append c to the automaton. if the state cur of the current factor is
+// split, the factor moves to the clone when it is short enough.
+void OnlineLZ77::extend(unsigned char c){
+  unsigned int z = newState(len[last] + 1, pos), p = last, q;
+  while(p != NONE && next(p, c) == NONE){
+    setNext(p, c, z);
+    p = link[p];
+  }
+  if(p == NONE){
+    link[z] = 0;
+  } else if(len[p] + 1 == len[q = next(p, c)]){
+    link[z] = q;
+  } else {
+    unsigned int clone = newState(len[p] + 1, first[q]);
+    for(unsigned int e = head[q]; e != NONE; e = edgeNext[e]){
+      setNext(clone, edgeChar[e], next(q, edgeChar[e]));
+    }
+    link[clone] = link[q];
+    while(p != NONE && next(p, c) == q){
+      setNext(p, c, clone);
+      p = link[p];
+    }
+    link[q] = link[z] = clone;
+    if(cur == q && mlen <= len[clone]) cur = clone;
+  }
+  last = z;
+}
+
+// the current factor can be extended by c if s[beg..pos] occurs in
+// s[0..pos), i.e. starts before beg.
+void OnlineLZ77::push(const unsigned char * str, unsigned int n,
+		      LZFactors & factors){
+  for(unsigned int i = 0; i < n; i++){
+    unsigned char c = str[i];
+    unsigned int t = next(cur, c);
+    if(t == NONE && mlen > 0){
+      factors.push_back(LZFactor(beg, mlen, first[cur] + 1 - mlen));
+      beg = pos;
+      mlen = cur = 0;
+      t = next(0, c);
+    }
+    if(t == NONE){                       // a new character
+      factors.push_back(LZFactor(pos, 0, pos));
+      beg = pos + 1;
+    } else {
+      cur = t;
+      mlen++;
+    }
+    extend(c);
+    pos++;
+  }
+}
+
+void OnlineLZ77::finish(LZFactors & factors){
+  if(mlen > 0) factors.push_back(LZFactor(beg, mlen, first[cur] + 1 - mlen));
+  beg = pos;
+  mlen = cur = 0;
+}
+
+size_t OnlineLZ77::bytes() const {
+  return (link.capacity() + len.capacity() + first.capacity() + head.capacity()
+	  + edgeNext.capacity() + hashTo.capacity()) * sizeof(unsigned int)
+    + hashKey.capacity() * sizeof(unsigned long long) + edgeChar.capacity() + sizeof(root);
 }
@@ -25,19 +25,182 @@
 #define __LZ77_HPP__
 #include <vector>
 #include <string>
+#include "runStats.hpp"
+#include "memoryResource.hpp"
+#include "runOptions.hpp"
 
 enum ALGFLAG {
   USE_LPF_ORIGINAL,   // use original CPS algorithm for calculating longest previous factor
+  USE_LZ_KKP,         // factorize directly from PSV/NSV of the suffix array (KKP3 style),
+                      // without lcp, rank and lpf arrays
+  USE_LPF_PEAK,       // lpf in one sweep from psv/nsv computed in place over the
+                      // suffix array by peak elimination
+  USE_LZ_ONLINE,      // factorize left to right with an online suffix automaton
+                      // (see OnlineLZ77)
+  USE_LPF_PARALLEL,   // the result of LPF_original, computed by several threads
+                      // from parallel all nearest smaller values (see
+                      // RunOptions::lzThreads)
+  USE_LZ_FM,          // factorize in compressed space by backward search on an
+                      // FM-index of the reversed text (bwt by divbwt)
+  NUM_ALGFLAGS
 };
 
+// a factor of the lz factorization (with overlaps, i.e. longest previous
+// factors) starting at beg: s[beg..beg+len) = s[src..src+len), src < beg.
+// len == 0 (and src == beg) for a character that did not occur before.
+class LZFactor {
+public:
+  unsigned int beg;
+  unsigned int len;
+  unsigned int src;
+  LZFactor(unsigned int beg_, unsigned int len_, unsigned int src_)
+    : beg(beg_), len(len_), src(src_) {}
+};
+
+typedef ResourceVector<LZFactor>::type LZFactors;
+
 class LZ77 {
 public:
+  // name of algf, as accepted by parse
+  static const char * name(enum ALGFLAG algf);
+  // algorithm named name. false if there is none.
+  static bool parse(const char * name, enum ALGFLAG & algf);
+
   // calculate longest previous factor (position and length)
-  // for each position of string str.
+  // for each position of string str (with LPF_peak for USE_LPF_PEAK,
+  // LPF_parallel for USE_LPF_PARALLEL if str is shorter than 2^31, and
+  // LPF_original otherwise: the other algorithms only compute
+  // factorizations).
+  // if stats is not NULL, the time of each stage is added to it.
+  // if dna is not NULL, it is str packed (see packedDna.hpp), and the
+  // comparisons of the lpf scans use it. opts gives the suffix sorting,
+  // the threads of USE_LPF_PARALLEL and the placement of the arrays.
+  static void lpf(const std::string & str,
+		  UIntArray & POS,
+		  UIntArray & LEN,
+		  enum ALGFLAG = USE_LPF_ORIGINAL,
+		  RunStats * stats = NULL,
+		  const PackedDNA * dna = NULL,
+		  const RunOptions & opts = RunOptions());
+
+  // same as above, for the string str[0..n-1] of symbols of type T:
+  // unsigned char, unsigned short or unsigned int (dna must be NULL for
+  // the wider ones).
+  template <class T>
+  static void lpf(const T * str, unsigned int n,
+		  UIntArray & POS,
+		  UIntArray & LEN,
+		  enum ALGFLAG = USE_LPF_ORIGINAL,
+		  RunStats * stats = NULL,
+		  const PackedDNA * dna = NULL,
+		  const RunOptions & opts = RunOptions());
+
+  // lz factorization of str[0..n-1], where the factor beginning at i has
+  // the length of the longest previous factor at i (at least 1).
+  // the algorithms that compute lpf arrays read it off them.
+  // T as for lpf. USE_LZ_ONLINE and USE_LZ_FM take bytes only; texts of
+  // wider symbols are factorized with LPF_original instead.
+  template <class T>
+  static void factorize(const T * str, unsigned int n,
+			LZFactors & factors,
+			enum ALGFLAG = USE_LPF_ORIGINAL,
+			RunStats * stats = NULL,
+			const PackedDNA * dna = NULL,
+			const RunOptions & opts = RunOptions());
+
+  // the same with std::vector, the types of these functions before the
+  // arrays were taken from a MemoryResource. the arrays are computed in
+  // the current resource and copied out, which takes 8n (or 12 bytes per
+  // factor) more at the end.
   static void lpf(const std::string & str,
 		  std::vector<unsigned int> & POS,
 		  std::vector<unsigned int> & LEN,
-		  enum ALGFLAG = USE_LPF_ORIGINAL);
+		  enum ALGFLAG algf = USE_LPF_ORIGINAL,
+		  RunStats * stats = NULL,
+		  const PackedDNA * dna = NULL,
+		  const RunOptions & opts = RunOptions()){
+    lpf(reinterpret_cast<const unsigned char *>(str.data()), str.size(), POS, LEN, algf, stats, dna,
+	opts);
+  }
+  template <class T>
+  static void lpf(const T * str, unsigned int n,
+		  std::vector<unsigned int> & POS,
+		  std::vector<unsigned int> & LEN,
+		  enum ALGFLAG algf = USE_LPF_ORIGINAL,
+		  RunStats * stats = NULL,
+		  const PackedDNA * dna = NULL,
+		  const RunOptions & opts = RunOptions()){
+    UIntArray pos, len;
+    lpf(str, n, pos, len, algf, stats, dna, opts);
+    POS.assign(pos.begin(), pos.end());
+    LEN.assign(len.begin(), len.end());
+  }
+  template <class T>
+  static void factorize(const T * str, unsigned int n,
+			std::vector<LZFactor> & factors,
+			enum ALGFLAG algf = USE_LPF_ORIGINAL,
+			RunStats * stats = NULL,
+			const PackedDNA * dna = NULL,
+			const RunOptions & opts = RunOptions()){
+    LZFactors f;
+    factorize(str, n, f, algf, stats, dna, opts);
+    factors.assign(f.begin(), f.end());
+  }
+};
+
+// the same lz factorization computed online, for text that arrives in
+// pieces. a suffix automaton (DAWG) of the text read so far is extended
+// one character at a time, while the current factor is matched against it.
+// a factor is complete as soon as the character following it arrives, so
+// the time to the first factor does not depend on the length of the input.
+// the source of a factor is its leftmost occurrence.
+// the automaton takes up to about 100 bytes per character.
+// see: A. Blumer et al., The Smallest Automaton Recognizing the Subwords
+// of a Text. Theoretical Computer Science 40: 31-55 (1985)
+class OnlineLZ77 {
+  static const unsigned int NONE = 0xffffffffu;
+  UIntArray link;                   // suffix link of each state
+  UIntArray len;                    // length of the longest string of each state
+  UIntArray first;                  // end position of its first occurrence
+  UIntArray head;                   // first out edge of each state (but the root)
+  UIntArray edgeNext;
+  ResourceVector<unsigned char>::type edgeChar;
+  ResourceVector<unsigned long long>::type hashKey;  // out edges (state, char) of all states
+  UIntArray hashTo;                                  // but the root, by open addressing
+  unsigned int hashShift, nedges;
+  unsigned int root[256];           // out edges of the root
+  unsigned int last;                // state of the whole text
+  unsigned int cur, mlen, beg;      // current factor beg.., matched mlen chars to state cur
+  unsigned int pos;                 // characters read
+  size_t slot(unsigned long long key) const;
+  void rehash();
+  unsigned int next(unsigned int p, unsigned char c) const;
+  void setNext(unsigned int p, unsigned char c, unsigned int q);
+  unsigned int newState(unsigned int l, unsigned int f);
+  void extend(unsigned char c);
+public:
+  OnlineLZ77();
+  // read str[0..n-1], following the text read before. the factors that
+  // are completed are appended to factors.
+  void push(const unsigned char * str, unsigned int n,
+	    LZFactors & factors);
+  // the end of the text: append the last factor
+  void finish(LZFactors & factors);
+  // the same with std::vector (see LZ77::lpf)
+  void push(const unsigned char * str, unsigned int n,
+	    std::vector<LZFactor> & factors){
+    LZFactors f;
+    push(str, n, f);
+    factors.insert(factors.end(), f.begin(), f.end());
+  }
+  void finish(std::vector<LZFactor> & factors){
+    LZFactors f;
+    finish(f);
+    factors.insert(factors.end(), f.begin(), f.end());
+  }
+  unsigned int size() const { return pos; }
+  // bytes of the automaton
+  size_t bytes() const;
 };
 
 #endif//__LZ77_HPP__
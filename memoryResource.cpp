@@ -0,0 +1,179 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// memoryResource.cpp
+// memory resources (arenas) that serve the allocations of the engines
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2011 Hideo Bannai
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "memoryResource.hpp"
+#include <cstdlib>
+#include <cassert>
+
+using namespace std;
+
+// malloc / free. malloc aligns for any standard type, larger alignments
+// are taken with posix_memalign.
+class HeapResource : public MemoryResource {
+public:
+  void * allocate(size_t bytes, size_t align){
+    void * p = NULL;
+    if(align <= 2 * sizeof(void *)){
+      p = malloc(bytes > 0 ? bytes : 1);
+    } else if(posix_memalign(&p, align, bytes > 0 ? bytes : 1) != 0){
+      p = NULL;
+    }
+    if(p == NULL) throw bad_alloc();
+    return p;
+  }
+  void deallocate(void * p, size_t bytes, size_t align){
+    (void) bytes; (void) align;
+    free(p);
+  }
+};
+
+static HeapResource heapResource;
+static __thread MemoryResource * currentResource = NULL;
+
+MemoryResource * MemoryResource::heap(){
+  return &heapResource;
+}
+
+MemoryResource * MemoryResource::current(){
+  return currentResource ? currentResource : &heapResource;
+}
+
+void MemoryResource::setCurrent(MemoryResource * r){
+  currentResource = r;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+MonotonicResource::MonotonicResource(size_t initial_, MemoryResource * upstream_)
+  : upstream(upstream_), chunks(NULL), cur(NULL), end(NULL),
+    initial(initial_ > 0 ? initial_ : 1), nextSize(initial), total(0)
+{}
+
+void * MonotonicResource::allocate(size_t bytes, size_t align){
+  assert(align > 0 && (align & (align - 1)) == 0);
+  size_t p = (reinterpret_cast<size_t>(cur) + align - 1) & ~(align - 1);
+  if(cur == NULL || p + bytes > reinterpret_cast<size_t>(end)){
+    // a new chunk, at least twice the last one
+    size_t size = sizeof(Chunk) + bytes + align;
+    if(size < nextSize) size = nextSize;
+    Chunk * c = static_cast<Chunk *>(upstream->allocate(size, __alignof__(Chunk)));
+    c->next = chunks;
+    c->size = size;
+    chunks = c;
+    total += size;
+    nextSize = 2 * size;
+    cur = reinterpret_cast<char *>(c + 1);
+    end = reinterpret_cast<char *>(c) + size;
+    p = (reinterpret_cast<size_t>(cur) + align - 1) & ~(align - 1);
+  }
+  cur = reinterpret_cast<char *>(p + bytes);
+  return reinterpret_cast<void *>(p);
+}
+
+void MonotonicResource::deallocate(void * p, size_t bytes, size_t align){
+  (void) align;
+  if(static_cast<char *>(p) + bytes == cur) cur = static_cast<char *>(p);
+}
+
+void MonotonicResource::release(){
+  while(chunks != NULL){
+    Chunk * c = chunks;
+    chunks = c->next;
+    upstream->deallocate(c, c->size, __alignof__(Chunk));
+  }
+  cur = end = NULL;
+  nextSize = initial;
+  total = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+PoolResource::PoolResource(MemoryResource * upstream_, size_t maxFree_)
+  : upstream(upstream_), total(0), count(0), freeBytes(0), maxFree(maxFree_)
+{
+  for(unsigned int c = 0; c < NUM_CLASSES; c++) lists[c] = NULL;
+}
+
+// class 0 is up to 16 bytes. for 2^k < bytes <= 2^(k+1), k >= 4, the
+// sizes are 5, 6, 7 or 8 steps of 2^(k-2)
+unsigned int PoolResource::sizeClass(size_t bytes, size_t & size){
+  if(bytes <= MAX_ALIGN){
+    size = MAX_ALIGN;
+    return 0;
+  }
+  unsigned int k = 8 * sizeof(unsigned long) - 1 - __builtin_clzl(bytes - 1);
+  size_t step = (size_t) 1 << (k - 2);
+  size = (bytes + step - 1) & ~(step - 1);
+  return 1 + ((k - 4) << 2) + (size / step - 5);
+}
+
+void * PoolResource::allocate(size_t bytes, size_t align){
+  if(align > MAX_ALIGN){
+    count++;
+    return upstream->allocate(bytes, align);
+  }
+  size_t size;
+  unsigned int c = sizeClass(bytes, size);
+  Block * b = lists[c];
+  if(b != NULL){
+    lists[c] = b->next;
+    freeBytes -= size;
+    return b;
+  }
+  void * p = upstream->allocate(size, MAX_ALIGN);
+  count++;
+  total += size;
+  return p;
+}
+
+void PoolResource::deallocate(void * p, size_t bytes, size_t align){
+  if(align > MAX_ALIGN){
+    upstream->deallocate(p, bytes, align);
+    return;
+  }
+  size_t size;
+  unsigned int c = sizeClass(bytes, size);
+  if(size > maxFree - freeBytes){
+    upstream->deallocate(p, size, MAX_ALIGN);
+    total -= size;
+    return;
+  }
+  Block * b = static_cast<Block *>(p);
+  b->next = lists[c];
+  lists[c] = b;
+  freeBytes += size;
+}
+
+void PoolResource::release(){
+  for(unsigned int c = 0; c < NUM_CLASSES; c++){
+    // the size of class c (see sizeClass)
+    size_t size = c == 0 ? MAX_ALIGN : (size_t) (5 + ((c - 1) & 3)) << (((c - 1) >> 2) + 2);
+    while(lists[c] != NULL){
+      Block * b = lists[c];
+      lists[c] = b->next;
+      upstream->deallocate(b, size, MAX_ALIGN);
+      total -= size;
+    }
+  }
+  freeBytes = 0;
+}
@@ -0,0 +1,221 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// memoryResource.hpp
+// memory resources (arenas) that serve the allocations of the engines
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2011 Hideo Bannai
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __MEMORY_RESOURCE_HPP__
+#define __MEMORY_RESOURCE_HPP__
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+// a source of memory, in the manner of std::pmr::memory_resource.
+// every container of the engines (suffix, rank, lcp and lpf arrays, lz
+// factors, run lists, ...) takes its memory from the resource that was
+// current in its thread when it was constructed, so a caller can serve
+// all allocations of a call from an arena:
+//   MonotonicResource arena;
+//   { ResourceScope scope(&arena); runFinder::findRuns(s, runs); }
+//   arena.release();
+// the default is the heap (malloc / free).
+class MemoryResource {
+public:
+  virtual ~MemoryResource(){}
+  virtual void * allocate(size_t bytes, size_t align) = 0;
+  virtual void deallocate(void * p, size_t bytes, size_t align) = 0;
+  // the heap
+  static MemoryResource * heap();
+  // the resource of new containers in the calling thread
+  static MemoryResource * current();
+  static void setCurrent(MemoryResource * r);
+};
+
+// makes r the current resource of the calling thread until destruction
+class ResourceScope {
+  MemoryResource * prev;
+  ResourceScope(const ResourceScope &);
+  ResourceScope & operator=(const ResourceScope &);
+public:
+  ResourceScope(MemoryResource * r) : prev(MemoryResource::current()){ MemoryResource::setCurrent(r); }
+  ~ResourceScope(){ MemoryResource::setCurrent(prev); }
+};
+
+// arena: memory is taken from chunks of growing size allocated from
+// upstream, and is only freed all at once by release() (or destruction).
+// deallocating the last allocation gives it back, so a vector growing at
+// the end of the arena does not leave its old buffers behind.
+// not thread safe: use one per thread.
+class MonotonicResource : public MemoryResource {
+  class Chunk {
+  public:
+    Chunk * next;
+    size_t size;                         // bytes, including this header
+  };
+  MemoryResource * upstream;
+  Chunk * chunks;
+  char * cur, * end;
+  size_t initial, nextSize, total;
+  MonotonicResource(const MonotonicResource &);
+  MonotonicResource & operator=(const MonotonicResource &);
+public:
+  MonotonicResource(size_t initial_ = 1 << 16, MemoryResource * upstream_ = MemoryResource::heap());
+  ~MonotonicResource(){ release(); }
+  void * allocate(size_t bytes, size_t align);
+  void deallocate(void * p, size_t bytes, size_t align);
+  // free all memory taken from upstream in O(chunks)
+  void release();
+  // bytes taken from upstream
+  size_t bytes() const { return total; }
+};
+
+// pool: freed memory is kept in free lists by size class (four classes
+// per power of two) and handed out again, so that repeating a computation
+// of about the same size takes nothing from upstream. the free lists hold
+// at most maxFree bytes: blocks freed beyond that go back upstream at
+// once, so that the buffers freed by one stage of a large computation do
+// not stay on top of those of the next. the rest goes back upstream by
+// release() (or destruction); alignments above 16 are passed through to
+// upstream.
+// not thread safe: use one per thread.
+class PoolResource : public MemoryResource {
+  class Block {
+  public:
+    Block * next;
+  };
+  enum { NUM_CLASSES = 241, MAX_ALIGN = 16 };
+  MemoryResource * upstream;
+  Block * lists[NUM_CLASSES];
+  size_t total, count, freeBytes, maxFree;
+  PoolResource(const PoolResource &);
+  PoolResource & operator=(const PoolResource &);
+  // the size class of bytes, and its size
+  static unsigned int sizeClass(size_t bytes, size_t & size);
+public:
+  PoolResource(MemoryResource * upstream_ = MemoryResource::current(),
+	       size_t maxFree_ = (size_t) -1);
+  ~PoolResource(){ release(); }
+  void * allocate(size_t bytes, size_t align);
+  void deallocate(void * p, size_t bytes, size_t align);
+  // give the free memory back to upstream
+  void release();
+  // bytes taken from upstream and not given back
+  size_t bytes() const { return total; }
+  // bytes of the free lists
+  size_t freeListBytes() const { return freeBytes; }
+  // number of allocations from upstream so far
+  size_t allocations() const { return count; }
+};
+
+// passes allocations through to upstream and counts the bytes
+// outstanding and their high water mark, to measure the memory of a call:
+//   CountingResource count;
+//   { ResourceScope scope(&count); runFinder::countRuns(s); }
+//   count.peak();
+// not thread safe: use one per thread.
+class CountingResource : public MemoryResource {
+  MemoryResource * upstream;
+  size_t cur, high, count;
+  CountingResource(const CountingResource &);
+  CountingResource & operator=(const CountingResource &);
+public:
+  CountingResource(MemoryResource * upstream_ = MemoryResource::current())
+    : upstream(upstream_), cur(0), high(0), count(0) {}
+  void * allocate(size_t bytes, size_t align){
+    void * p = upstream->allocate(bytes, align);
+    cur += bytes;
+    if(cur > high) high = cur;
+    count++;
+    return p;
+  }
+  void deallocate(void * p, size_t bytes, size_t align){
+    cur -= bytes;
+    upstream->deallocate(p, bytes, align);
+  }
+  // bytes allocated and not deallocated
+  size_t outstanding() const { return cur; }
+  // most bytes outstanding since construction or resetPeak()
+  size_t peak() const { return high; }
+  void resetPeak(){ high = cur; }
+  // number of allocations so far
+  size_t allocations() const { return count; }
+};
+
+// stl allocator of a memory resource (the current one by default)
+template <class T>
+class ResourceAllocator {
+public:
+  typedef T value_type;
+  typedef T * pointer;
+  typedef const T * const_pointer;
+  typedef T & reference;
+  typedef const T & const_reference;
+  typedef size_t size_type;
+  typedef ptrdiff_t difference_type;
+  template <class U> struct rebind { typedef ResourceAllocator<U> other; };
+  MemoryResource * res;
+  ResourceAllocator() : res(MemoryResource::current()) {}
+  ResourceAllocator(MemoryResource * r) : res(r) {}
+  template <class U> ResourceAllocator(const ResourceAllocator<U> & o) : res(o.res) {}
+  pointer address(reference x) const { return &x; }
+  const_pointer address(const_reference x) const { return &x; }
+  pointer allocate(size_type n, const void * = 0){
+    return static_cast<pointer>(res->allocate(n * sizeof(T), __alignof__(T)));
+  }
+  void deallocate(pointer p, size_type n){ res->deallocate(p, n * sizeof(T), __alignof__(T)); }
+  size_type max_size() const { return ((size_t) -1) / sizeof(T); }
+  void construct(pointer p, const T & v){ new(static_cast<void *>(p)) T(v); }
+  void destroy(pointer p){ p->~T(); }
+};
+
+template <class T, class U>
+bool operator==(const ResourceAllocator<T> & a, const ResourceAllocator<U> & b){ return a.res == b.res; }
+template <class T, class U>
+bool operator!=(const ResourceAllocator<T> & a, const ResourceAllocator<U> & b){ return a.res != b.res; }
+
+// vector of the current resource: ResourceVector<T>::type
+template <class T>
+class ResourceVector {
+public:
+  typedef std::vector<T, ResourceAllocator<T> > type;
+};
+
+typedef ResourceVector<unsigned int>::type UIntArray;
+
+// free the memory of v (it stays with the same resource)
+template <class T, class A>
+void freeVector(std::vector<T, A> & v){
+  std::vector<T, A>(v.get_allocator()).swap(v);
+}
+
+// move the contents of from to to, without copying them if both have the
+// same resource. from is freed.
+template <class T, class A>
+void moveVector(std::vector<T, A> & from, std::vector<T, A> & to){
+  if(from.get_allocator() == to.get_allocator()){
+    to.swap(from);
+  } else {
+    to.assign(from.begin(), from.end());
+  }
+  freeVector(from);
+}
+
+#endif//__MEMORY_RESOURCE_HPP__
@@ -0,0 +1,160 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// packedDna.cpp
+// dna text packed two bits per base, for fast longest common extensions
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2011 Hideo Bannai
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "packedDna.hpp"
+#include <algorithm>
+#include <cassert>
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////////////
+
+const char * PackedDNA::name(enum DNAMODE m){
+  switch(m){
+  case DNA_OFF:  return "off";
+  case DNA_AUTO: return "auto";
+  case DNA_ON:   return "on";
+  default:       return "unknown";
+  }
+}
+
+bool PackedDNA::parse(const char * name, enum DNAMODE & m){
+  for(unsigned int k = 0; k < NUM_DNAMODES; k++){
+    if(string(name) == PackedDNA::name(static_cast<enum DNAMODE>(k))){
+      m = static_cast<enum DNAMODE>(k);
+      return true;
+    }
+  }
+  return false;
+}
+
+bool PackedDNA::pack(const unsigned char * s, unsigned int n_, enum DNAMODE m){
+  unsigned int p, c, nexc = 0, count[256];
+  int code[256];
+  freeVector(words);
+  freeVector(excPos);
+  freeVector(excSym);
+  n = 0;
+  if(m == DNA_OFF) return false;
+  // the bases are upper or lower case, whichever is more frequent
+  for(c = 0; c < 256; c++) count[c] = 0;
+  for(p = 0; p < n_; p++) count[s[p]]++;
+  bases = (count['A'] + count['C'] + count['G'] + count['T']
+	   >= count['a'] + count['c'] + count['g'] + count['t']) ? "ACGT" : "acgt";
+  for(c = 0; c < 256; c++) code[c] = -1;
+  for(c = 0; c < 4; c++) code[(unsigned char) bases[c]] = c;
+  for(c = 0; c < 256; c++) if(code[c] < 0) nexc += count[c];
+  if(m == DNA_AUTO && (n_ == 0 || nexc > n_ / 64)) return false;
+  n = n_;
+  words.assign(((size_t) n + 63) / 32 + 2, 0);
+  excPos.reserve(nexc);
+  excSym.reserve(nexc);
+  for(p = 0; p < n; p++){
+    int b = code[s[p]];
+    if(b < 0){
+      excPos.push_back(p);
+      excSym.push_back(s[p]);
+      b = 0;
+    }
+    size_t q = (size_t) p + 32;
+    words[q >> 5] |= (unsigned long long) b << (2 * (q & 31));
+  }
+  return true;
+}
+
+unsigned int PackedDNA::nextException(unsigned int p) const {
+  UIntArray::const_iterator it = lower_bound(excPos.begin(), excPos.end(), p);
+  return (it == excPos.end()) ? n : *it;
+}
+
+unsigned int PackedDNA::prevException(unsigned int p) const {
+  UIntArray::const_iterator it = lower_bound(excPos.begin(), excPos.end(), p);
+  return (it == excPos.begin()) ? 0 : *(it - 1) + 1;
+}
+
+unsigned char PackedDNA::operator[](unsigned int p) const {
+  assert(p < n);
+  UIntArray::const_iterator it = lower_bound(excPos.begin(), excPos.end(), p);
+  if(it != excPos.end() && *it == p) return excSym[it - excPos.begin()];
+  return bases[window(p) & 3];
+}
+
+// the packed bases only, as if the exceptions were A
+unsigned int PackedDNA::packedLce(unsigned int i, unsigned int j, unsigned int m) const {
+  unsigned int l = 0;
+  while(l < m){
+    unsigned long long x = window(i + l) ^ window(j + l);
+    if(x){
+      l += __builtin_ctzll(x) >> 1;
+      break;
+    }
+    l += 32;
+  }
+  return min(l, m);
+}
+
+unsigned int PackedDNA::packedLcs(unsigned int i, unsigned int j, unsigned int m) const {
+  unsigned int l = 0;
+  while(l < m){
+    unsigned long long x = window((long long) i - l - 32) ^ window((long long) j - l - 32);
+    if(x){
+      l += __builtin_clzll(x) >> 1;
+      break;
+    }
+    l += 32;
+  }
+  return min(l, m);
+}
+
+// the packed bases agree up to the first exception at offset e in either
+// string; there the symbols are compared, and the scan goes on after it.
+unsigned int PackedDNA::lce(unsigned int i, unsigned int j, unsigned int m) const {
+  unsigned int d = 0, l, e;
+  while(true){
+    l = d + packedLce(i + d, j + d, m - d);
+    if(excPos.empty()) return l;
+    e = min(nextException(i + d) - i, nextException(j + d) - j);
+    if(e > l || e >= m) return l;
+    if((*this)[i + e] != (*this)[j + e]) return e;
+    d = e + 1;
+  }
+}
+
+unsigned int PackedDNA::lcs(unsigned int i, unsigned int j, unsigned int m) const {
+  unsigned int d = 0, l, e, pi, pj;
+  while(true){
+    l = d + packedLcs(i - d, j - d, m - d);
+    if(excPos.empty()) return l;
+    pi = prevException(i - d);
+    pj = prevException(j - d);
+    e = min(pi ? i - pi : n, pj ? j - pj : n);
+    if(e > l || e >= m) return l;
+    if((*this)[i - 1 - e] != (*this)[j - 1 - e]) return e;
+    d = e + 1;
+  }
+}
+
+size_t PackedDNA::bytes() const {
+  return words.capacity() * sizeof(unsigned long long)
+    + excPos.capacity() * sizeof(unsigned int) + excSym.capacity();
+}
@@ -0,0 +1,109 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// packedDna.hpp
+// dna text packed two bits per base, for fast longest common extensions
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2011 Hideo Bannai
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __PACKED_DNA_HPP__
+#define __PACKED_DNA_HPP__
+
+#include <string>
+#include "memoryResource.hpp"
+
+// when run finding packs the text (see PackedDNA::pack and RunOptions::dna)
+enum DNAMODE {
+  DNA_OFF,     // never (default)
+  DNA_AUTO,    // if at most 1/64 of the text are not bases
+  DNA_ON,      // always
+  NUM_DNAMODES
+};
+
+// the text with its bases, A, C, G and T or a, c, g and t (whichever is
+// more frequent), packed two bits per base, 32 bases per 64 bit word.
+// any other symbol (N, the other case, ...) is packed as the first base
+// and kept in a sorted exception list of (position, symbol).
+// longest common extensions compare 32 bases at a time with a xor of
+// two words, and are used by the lpf and type 1 run scans instead of
+// comparing byte by byte. the packed text takes n/4 bytes plus 5 bytes
+// per exception.
+class PackedDNA {
+  ResourceVector<unsigned long long>::type words;  // base p at bits 2(p+32) (one word of padding in front)
+  UIntArray excPos;                                // positions of the exceptions
+  ResourceVector<unsigned char>::type excSym;      // and their symbols
+  unsigned int n;
+  const char * bases;                              // "ACGT" or "acgt"
+  PackedDNA(const PackedDNA &);
+  PackedDNA & operator=(const PackedDNA &);
+  // bases p..p+31 (p may be -32) in the low to high bits of a word
+  unsigned long long window(long long p) const {
+    unsigned long long q = p + 32, w = q >> 5, off = 2 * (q & 31);
+    return off ? (words[w] >> off) | (words[w + 1] << (64 - off)) : words[w];
+  }
+  // position of the first exception at or after p (n if none)
+  unsigned int nextException(unsigned int p) const;
+  // position of the last exception before p, plus 1 (0 if none)
+  unsigned int prevException(unsigned int p) const;
+  unsigned int packedLce(unsigned int i, unsigned int j, unsigned int m) const;
+  unsigned int packedLcs(unsigned int i, unsigned int j, unsigned int m) const;
+public:
+  PackedDNA() : n(0), bases("ACGT") {}
+  // name of m, as accepted by parse
+  static const char * name(enum DNAMODE m);
+  // mode named name. false if there is none.
+  static bool parse(const char * name, enum DNAMODE & m);
+  // pack s[0..n-1] if mode m allows it. returns false (and stays
+  // empty) otherwise.
+  bool pack(const unsigned char * s, unsigned int n_, enum DNAMODE m);
+  bool empty() const { return words.empty(); }
+  unsigned int size() const { return n; }
+  // the symbol at position p
+  unsigned char operator[](unsigned int p) const;
+  // length of the longest common prefix of s[i..) and s[j..), at most m
+  // (m <= n - max(i, j))
+  unsigned int lce(unsigned int i, unsigned int j, unsigned int m) const;
+  // length of the longest common suffix of s[..i) and s[..j), at most m
+  // (m <= min(i, j))
+  unsigned int lcs(unsigned int i, unsigned int j, unsigned int m) const;
+  // bytes of the packed text and the exceptions
+  size_t bytes() const;
+};
+
+// lce and lcs of s (as those of PackedDNA) for the scans: most extensions
+// are short, so the first symbols are compared directly, and the rest on
+// the packed text dna if it is not NULL (bytes only).
+static const unsigned int DNA_BYTES = 8;
+
+template <class T>
+inline unsigned int dnaLce(const T * s, const PackedDNA * dna,
+			   unsigned int i, unsigned int j, unsigned int m){
+  unsigned int l = 0, b = (dna && m > DNA_BYTES) ? DNA_BYTES : m;
+  while(l < b && s[i+l] == s[j+l]) l++;
+  return (!dna || l < b || l == m) ? l : l + dna->lce(i + l, j + l, m - l);
+}
+
+template <class T>
+inline unsigned int dnaLcs(const T * s, const PackedDNA * dna,
+			   unsigned int i, unsigned int j, unsigned int m){
+  unsigned int l = 0, b = (dna && m > DNA_BYTES) ? DNA_BYTES : m;
+  while(l < b && s[i-1-l] == s[j-1-l]) l++;
+  return (!dna || l < b || l == m) ? l : l + dna->lcs(i - l, j - l, m - l);
+}
+
+#endif//__PACKED_DNA_HPP__
@@ -0,0 +1,98 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// perfCounters.cpp
+// hardware performance counters of the calling thread
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2011 Hideo Bannai
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "perfCounters.hpp"
+#include <cstring>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#endif
+
+#ifdef __linux__
+static const unsigned int TYPE[NUM_COUNTERS] = {
+  PERF_TYPE_HARDWARE,
+  PERF_TYPE_HARDWARE,
+  PERF_TYPE_HARDWARE,
+  PERF_TYPE_HARDWARE,
+  PERF_TYPE_HW_CACHE
+};
+static const unsigned long long CONFIG[NUM_COUNTERS] = {
+  PERF_COUNT_HW_CPU_CYCLES,
+  PERF_COUNT_HW_INSTRUCTIONS,
+  PERF_COUNT_HW_CACHE_MISSES,
+  PERF_COUNT_HW_BRANCH_MISSES,
+  PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)
+};
+#endif
+
+PerfCounters::PerfCounters(){
+  for(unsigned int c = 0; c < NUM_COUNTERS; c++){
+    fd[c] = -1;
+#ifdef __linux__
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type = TYPE[c];
+    attr.size = sizeof(attr);
+    attr.config = CONFIG[c];
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    fd[c] = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+#endif
+  }
+}
+
+PerfCounters::~PerfCounters(){
+  for(unsigned int c = 0; c < NUM_COUNTERS; c++){
+    if(fd[c] >= 0) close(fd[c]);
+  }
+}
+
+unsigned int PerfCounters::availableMask() const {
+  unsigned int m = 0;
+  for(unsigned int c = 0; c < NUM_COUNTERS; c++){
+    if(fd[c] >= 0) m |= 1 << c;
+  }
+  return m;
+}
+
+void PerfCounters::read(unsigned long long values[NUM_COUNTERS]) const {
+  for(unsigned int c = 0; c < NUM_COUNTERS; c++){
+    unsigned long long v[3];            // value, time enabled, time running
+    values[c] = 0;
+    if(fd[c] < 0 || ::read(fd[c], v, sizeof(v)) != sizeof(v)) continue;
+    values[c] = (v[2] > 0 && v[2] < v[1]) ? (unsigned long long) ((double) v[0] * v[1] / v[2]) : v[0];
+  }
+}
+
+const char * PerfCounters::name(enum COUNTER c){
+  switch(c){
+  case COUNTER_CYCLES:        return "cycles";
+  case COUNTER_INSTRUCTIONS:  return "instructions";
+  case COUNTER_CACHE_MISSES:  return "cache_misses";
+  case COUNTER_BRANCH_MISSES: return "branch_misses";
+  case COUNTER_DTLB_MISSES:   return "dtlb_misses";
+  default:                    return "unknown";
+  }
+}
@@ -0,0 +1,56 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// perfCounters.hpp
+// hardware performance counters of the calling thread
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2011 Hideo Bannai
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __PERF_COUNTERS_HPP__
+#define __PERF_COUNTERS_HPP__
+
+enum COUNTER {
+  COUNTER_CYCLES,
+  COUNTER_INSTRUCTIONS,
+  COUNTER_CACHE_MISSES,    // last level cache misses
+  COUNTER_BRANCH_MISSES,
+  COUNTER_DTLB_MISSES,     // data tlb load misses
+  NUM_COUNTERS
+};
+
+// hardware counters of the calling thread (user space only), read with
+// perf_event_open(2) on linux. counters that cannot be opened (no pmu in
+// a virtual machine, perf_event_paranoid, other systems) are unavailable
+// and read as 0, so callers need not check.
+// the counters count only in the thread that constructed the object.
+class PerfCounters {
+  int fd[NUM_COUNTERS];
+  PerfCounters(const PerfCounters &);
+  PerfCounters & operator=(const PerfCounters &);
+public:
+  PerfCounters();
+  ~PerfCounters();
+  bool available(enum COUNTER c) const { return fd[c] >= 0; }
+  // bit c is set if counter c is available
+  unsigned int availableMask() const;
+  // current values, scaled up if the kernel multiplexed the counters
+  void read(unsigned long long values[NUM_COUNTERS]) const;
+  static const char * name(enum COUNTER c);
+};
+
+#endif//__PERF_COUNTERS_HPP__
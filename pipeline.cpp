@@ -0,0 +1,336 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// pipeline.cpp
+// reader / compute / writer pipeline for finding runs of many records
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2011 Hideo Bannai
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "pipeline.hpp"
+#include "spscQueue.hpp"
+#include "bits.h"
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+
+using namespace std;
+
+typedef SPSCQueue<RecordBatch> BatchQueue;
+
+// state shared by the stages of one RunPipeline::process call
+class PipelineState {
+public:
+  const vector<const char *> * files;
+  enum SEQFORMAT fmt;
+  enum ALGFLAG algf;
+  RunOptions opts;
+  size_t batchBytes;
+  bool stats;                            // collect statistics
+  vector<BatchQueue *> in, out;          // one pair per worker
+  size_t nbatches;                       // batches sent by reader
+  string err;                            // written by reader only
+};
+
+class WorkerArg {
+public:
+  PipelineState * st;
+  unsigned int id;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+// s[0..n-1] as a JSON string
+static string jsonString(const char * s, size_t n){
+  string out("\"");
+  char buf[8];
+  for(size_t i = 0; i < n; i++){
+    unsigned char c = s[i];
+    if(c == '"' || c == '\\'){
+      out += '\\';
+      out += c;
+    } else if(c < 0x20){
+      snprintf(buf, sizeof(buf), "\\u%04x", c);
+      out += buf;
+    } else {
+      out += c;
+    }
+  }
+  return out + "\"";
+}
+
+// hand a batch to the next worker
+static void sendBatch(PipelineState * st, RecordBatch * b){
+  st->in[st->nbatches++ % st->in.size()]->push(b);
+}
+
+// true if path is a regular, uncompressed file that can be mapped
+static bool mappable(const char * path){
+  int fd = (strcmp(path, "-") == 0) ? 0 : open(path, O_RDONLY);
+  struct stat sb;
+  unsigned char magic[4];
+  bool ok = false;
+  if(fd < 0) return true;               // let MappedFile report the error
+  if(fstat(fd, &sb) == 0 && S_ISREG(sb.st_mode)){
+    ssize_t r = pread(fd, magic, sizeof(magic), 0);
+    ok = (r >= 0 && InputDecoder::detect(magic, r) == COMP_NONE);
+  }
+  if(fd != 0) close(fd);
+  return ok;
+}
+
+// parse a mapped file in windows of about batchBytes
+static void readMapped(PipelineState * st, const char * path){
+  MappedFile * mf = new MappedFile;
+  if(!mf->open(path)){
+    st->err = string(path) + ": " + strerror(errno);
+    delete mf;
+    return;
+  }
+  SeqParser parser(st->fmt);
+  size_t off = 0, win = st->batchBytes;
+  while(true){
+    size_t rest = mf->size() - off;
+    bool last = (win >= rest);
+    RecordBatch * b = new RecordBatch;
+    b->file = mf;
+    TraceSpan span("parse", st->nbatches);
+    off += parser.parse(mf->begin() + off, last ? rest : win, last, b->recs);
+    span.end();
+    if(!parser.error().empty()){
+      st->err = string(path) + ": " + parser.error();
+      last = true;
+    }
+    if(!last && b->recs.empty()){        // record larger than the window
+      delete b;
+      win *= 2;
+      continue;
+    }
+    b->lastOfFile = last;
+    sendBatch(st, b);
+    if(last) break;
+    win = st->batchBytes;
+  }
+}
+
+// parse the blocks of a decoder thread as they arrive.
+// the unparsed tail of a block (a record continuing into the next block)
+// is carried over into the headroom of the next block when it fits.
+// a record that is still incomplete is parsed again only once the carry
+// has doubled (as the window of readMapped), so that long records are
+// parsed in linear time.
+static void readDecoded(PipelineState * st, const char * path){
+  InputDecoder dec(st->batchBytes, st->batchBytes / 16);
+  SeqParser parser(st->fmt);
+  DataBlock * carry = NULL, * cur;
+  size_t tried = 0;                      // bytes of the carry when it was last parsed
+  if(!dec.start(path)){
+    st->err = dec.error();
+    return;
+  }
+  while(st->err.empty()){
+    DataBlock * blk = dec.next();
+    bool last = (blk == NULL);
+    if(last && !dec.error().empty()){
+      st->err = string(path) + ": " + dec.error();
+      break;
+    }
+    if(carry == NULL){
+      cur = blk;
+    } else if(last){
+      cur = carry;
+    } else if(carry->size <= blk->headroom){
+      blk->data -= carry->size;
+      blk->headroom -= carry->size;
+      blk->capacity += carry->size;
+      blk->size += carry->size;
+      memcpy(blk->data, carry->data, carry->size);
+      cur = blk;
+      delete carry;
+    } else {
+      // a long record: grow the carry geometrically to keep copying linear
+      if(carry->capacity - carry->size >= blk->size){
+	cur = carry;
+      } else {
+	cur = new DataBlock(0, 2 * (carry->size + blk->size));
+	memcpy(cur->data, carry->data, carry->size);
+	cur->size = carry->size;
+	delete carry;
+      }
+      memcpy(cur->data + cur->size, blk->data, blk->size);
+      cur->size += blk->size;
+      delete blk;
+    }
+    carry = NULL;
+    if(cur == NULL) break;
+    if(!last && cur->size < 2 * tried){
+      carry = cur;                       // too little new data to parse again
+      continue;
+    }
+    RecordBatch * b = new RecordBatch;
+    b->block = cur;
+    TraceSpan span("parse", st->nbatches);
+    size_t used = parser.parse(cur->data, cur->size, last, b->recs);
+    span.end();
+    if(!parser.error().empty()){
+      st->err = string(path) + ": " + parser.error();
+    } else if(used == 0 && !last){
+      carry = cur;                       // nothing complete yet
+      b->block = NULL;
+    } else if(used < cur->size && !last){
+      carry = new DataBlock(0, cur->size - used);
+      memcpy(carry->data, cur->data + used, cur->size - used);
+      carry->size = cur->size - used;
+    }
+    tried = carry ? carry->size : 0;
+    if(b->recs.empty()) delete b; else sendBatch(st, b);
+    if(last) break;
+  }
+  delete carry;
+}
+
+static void * readerThread(void * arg){
+  PipelineState * st = static_cast<PipelineState *>(arg);
+  size_t w, nw = st->in.size();
+  Trace::setThreadName("reader");
+  for(unsigned int f = 0; f < st->files->size() && st->err.empty(); f++){
+    const char * path = (*st->files)[f];
+    if(mappable(path)){
+      readMapped(st, path);
+    } else {
+      readDecoded(st, path);
+    }
+  }
+  for(w = 0; w < nw; w++) st->in[(st->nbatches + w) % nw]->push(NULL);
+  return NULL;
+}
+
+static void * workerThread(void * arg){
+  WorkerArg * wa = static_cast<WorkerArg *>(arg);
+  PipelineState * st = wa->st;
+  RecordBatch * b;
+  struct timeval btv, etv;
+  char name[32];
+  snprintf(name, sizeof(name), "worker %u", wa->id);
+  Trace::setThreadName(name);
+  PerfCounters * perf = st->stats ? new PerfCounters : NULL;
+  RunFinderContext ctx;                  // buffers reused (up to its maxFree)
+  ctx.options() = st->opts;
+  while((b = st->in[wa->id]->pop()) != NULL){
+    TraceSpan span("batch");
+    b->runs.resize(b->recs.size());
+    b->seconds.resize(b->recs.size());
+    if(st->stats){
+      b->stats.resize(b->recs.size());
+      for(unsigned int r = 0; r < b->recs.size(); r++) b->stats[r].perf = perf;
+    }
+    for(unsigned int r = 0; r < b->recs.size(); r++){
+      TraceSpan rspan("record", b->recs[r].len);
+      assert(b->recs[r].len <= SeqParser::MAX_LEN);  // longer ones are rejected by the parser
+      gettimeofday(&btv, NULL);
+      ctx.findRuns(reinterpret_cast<const unsigned char *>(b->recs[r].seq),
+		   b->recs[r].len, b->runs[r], st->algf,
+		   st->stats ? &b->stats[r] : NULL);
+      gettimeofday(&etv, NULL);
+      b->seconds[r] = timediff(btv, etv);
+    }
+    span.end();
+    st->out[wa->id]->push(b);
+  }
+  st->out[wa->id]->push(NULL);
+  delete perf;
+  return NULL;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+RunPipeline::RunPipeline(RunWriter & writer_, unsigned int nworkers_, enum ALGFLAG algf_)
+  : writer(writer_), nworkers(nworkers_ > 0 ? nworkers_ : 1), fmt(SEQ_AUTO),
+    algf(algf_), batchBytes(1 << 22), queueDepth(4), statsOut(NULL), nrecords(0)
+{};
+
+bool RunPipeline::process(const vector<const char *> & files){
+  PipelineState st;
+  vector<WorkerArg> args(nworkers);
+  vector<pthread_t> workers(nworkers);
+  pthread_t reader;
+  unsigned int w, started = 0;
+  st.files = &files;
+  st.fmt = fmt;
+  st.algf = algf;
+  st.opts = opts;
+  st.batchBytes = batchBytes;
+  st.stats = (statsOut != NULL);
+  st.nbatches = 0;
+  for(w = 0; w < nworkers; w++){
+    st.in.push_back(new BatchQueue(queueDepth));
+    st.out.push_back(new BatchQueue(queueDepth));
+  }
+  err.clear();
+  for(w = 0; w < nworkers; w++){
+    args[w].st = &st;
+    args[w].id = w;
+    if(pthread_create(&workers[w], NULL, workerThread, &args[w]) != 0) break;
+    started++;
+  }
+  if(started < nworkers || pthread_create(&reader, NULL, readerThread, &st) != 0){
+    err = "could not start pipeline threads";
+    for(w = 0; w < started; w++) st.in[w]->push(NULL);
+    for(w = 0; w < started; w++) pthread_join(workers[w], NULL);
+  } else {
+    // this thread is the writer
+    RecordBatch * b;
+    char timebuf[64];
+    Trace::setThreadName("writer");
+    for(w = 0; (b = st.out[w]->pop()) != NULL; w = (w + 1) % nworkers){
+      TraceSpan span("write");
+      for(unsigned int r = 0; r < b->recs.size(); r++){
+	const SeqRecord & rec = b->recs[r];
+	writer.writeRecord(rec.name, rec.name_len, rec.len, b->runs[r]);
+	if(writer.format() == RUNS_TEXT){
+	  int l = snprintf(timebuf, sizeof(timebuf), "Total Time: approx %.5f seconds\n",
+			   b->seconds[r]);
+	  writer.writeText(timebuf, l);
+	}
+	if(statsOut){
+	  fprintf(statsOut, "{\"record\": %lu, \"name\": %s, \"length\": %lu, \"stats\": %s}\n",
+		  (unsigned long) nrecords, jsonString(rec.name, rec.name_len).c_str(),
+		  (unsigned long) rec.len, b->stats[r].json().c_str());
+	  total.add(b->stats[r]);
+	}
+	nrecords++;
+      }
+      if(b->lastOfFile) delete b->file;
+      delete b;
+      span.end();
+    }
+    pthread_join(reader, NULL);
+    for(w = 0; w < nworkers; w++) pthread_join(workers[w], NULL);
+    err = st.err;
+  }
+  for(w = 0; w < nworkers; w++){
+    delete st.in[w];
+    delete st.out[w];
+  }
+  return err.empty();
+}
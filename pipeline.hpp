@@ -0,0 +1,93 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// pipeline.hpp
+// reader / compute / writer pipeline for finding runs of many records
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2011 Hideo Bannai
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __PIPELINE_HPP__
+#define __PIPELINE_HPP__
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "runFinder.hpp"
+#include "runIO.hpp"
+#include "seqReader.hpp"
+#include "inputDecoder.hpp"
+
+// a batch of consecutive records, passed between the stages by pointer
+class RecordBatch {
+public:
+  std::vector<SeqRecord> recs;
+  std::vector<std::vector<run> > runs;   // runs of each record
+  std::vector<double> seconds;           // time to compute them
+  std::vector<RunStats> stats;           // their statistics, if collected
+  MappedFile * file;                     // mapped file the records point into
+  bool lastOfFile;                       // the writer releases file after this batch
+  DataBlock * block;                     // or decoded block they point into (owned)
+  RecordBatch() : file(NULL), lastOfFile(false), block(NULL) {}
+  ~RecordBatch(){ delete block; }
+};
+
+// three stage pipeline:
+//   reader:  maps the input files and parses them into batches of records.
+//            compressed files and pipes are decoded by an InputDecoder
+//            thread instead, and parsed block by block.
+//   workers: find the runs of each record of a batch
+//   writer:  writes the runs of each batch, in input order
+// each stage is a thread. the reader hands out batches to the workers
+// round robin, and the writer collects them in the same order, so each
+// worker has its own pair of bounded lock-free queues and no reordering
+// is needed.
+class RunPipeline {
+  RunWriter & writer;
+  unsigned int nworkers;
+  enum SEQFORMAT fmt;
+  enum ALGFLAG algf;
+  RunOptions opts;
+  size_t batchBytes;
+  size_t queueDepth;
+  FILE * statsOut;
+  RunStats total;
+  size_t nrecords;
+  std::string err;
+public:
+  RunPipeline(RunWriter & writer_, unsigned int nworkers_ = 1,
+	      enum ALGFLAG algf_ = USE_LPF_ORIGINAL);
+  void setInputFormat(enum SEQFORMAT f){ fmt = f; }
+  // settings of the engines of each worker
+  void setOptions(const RunOptions & o){ opts = o; }
+  // approximate number of input bytes per batch
+  void setBatchBytes(size_t b){ batchBytes = b; }
+  // number of batches that may wait in each queue
+  void setQueueDepth(size_t d){ queueDepth = d; }
+  // write the statistics of each record to f as a line of JSON
+  // (NULL: do not collect statistics)
+  void setStatsOutput(FILE * f){ statsOut = f; }
+  // process the files in order ("-" is stdin).
+  // returns false if some file could not be read or parsed (see error()).
+  bool process(const std::vector<const char *> & files);
+  const std::string & error() const { return err; }
+  // number of records written and their total statistics (if collected)
+  size_t records() const { return nrecords; }
+  const RunStats & totalStats() const { return total; }
+};
+
+#endif//__PIPELINE_HPP__
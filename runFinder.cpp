@@ -22,11 +22,14 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "runFinder.hpp"
+#include "largeArray.hpp"
+#include "packedDna.hpp"
 #include <cassert>
 #include <sys/time.h>
 #include <string>
 #include <iostream>
 #include <vector>
+#include <algorithm>
 
 using namespace std;
 
@@ -40,163 +43,531 @@ run::run(int b_pos_, int period_, int e_pos_)
   : b_pos(b_pos_), period(period_), e_pos(e_pos_)
 {};
 
-void runFinder::findRuns(const string & s, 
-			 vector<run> & runs, 
-			 enum ALGFLAG algf){
-  vector<vector<pair<unsigned int, unsigned int> > > runs_by_bpos;
-  runFinder::runsAux(s, runs_by_bpos, algf);
-  runs.clear();
-  vector<pair<unsigned int, unsigned int> >::const_reverse_iterator itr;  
-  for(unsigned int beginp = 0; beginp < runs_by_bpos.size(); beginp++){
-    for(itr = runs_by_bpos[beginp].rbegin(); itr != runs_by_bpos[beginp].rend(); itr++){
-      runs.push_back(run(beginp, (*itr).second, (*itr).first));
+void runFinder::findRuns(const string & s,
+			 RunSet & runs,
+			 enum ALGFLAG algf, RunStats * stats){
+  runFinder::findRuns(reinterpret_cast<const unsigned char *>(s.data()), s.size(), runs, algf, stats);
+}
+
+template <class T>
+void runFinder::findRuns(const T * s, unsigned int n,
+			 RunSet & runs,
+			 enum ALGFLAG algf, RunStats * stats){
+  RunFinderContext ctx(false);
+  ctx.findRuns(s, n, runs, algf, stats);
+}
+
+unsigned int runFinder::countRuns(const std::string & s, enum ALGFLAG algf, RunStats * stats){
+  return runFinder::countRuns(reinterpret_cast<const unsigned char *>(s.data()), s.size(), algf, stats);
+}
+
+template <class T>
+unsigned int runFinder::countRuns(const T * s, unsigned int n,
+				  enum ALGFLAG algf, RunStats * stats){
+  RunFinderContext ctx(false);
+  return ctx.countRuns(s, n, algf, stats);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+template <class T>
+void RunFinderContext::findRuns(const T * s, unsigned int n,
+				RunSet & runs,
+				enum ALGFLAG algf, RunStats * stats){
+  ResourceScope scope(resource());
+  UIntArray offsets;
+  RunList lists;
+  size_t count = runFinder::runsAux(s, n, offsets, lists, algf, stats, opts);
+  unsigned int beginp, k, maxp = 0, maxx = 0;
+  // field widths of the run set are determined by the largest values
+  for(beginp = 0; beginp < n; beginp++){
+    for(k = offsets[beginp]; k < offsets[beginp + 1]; k++){
+      maxp = max(maxp, lists[k].second);
+      maxx = max(maxx, lists[k].first - beginp + 1 - 2 * lists[k].second);
+    }
+  }
+  runs.init(n, count, maxp, maxx);
+  for(beginp = 0; beginp < n; beginp++){
+    for(k = offsets[beginp + 1]; k-- > offsets[beginp];){
+      runs.push_back(beginp, lists[k].second, lists[k].first);
     }
   }
-  return;
 }
 
-unsigned int runFinder::countRuns(const std::string & s, enum ALGFLAG algf){
-  vector<vector<pair<unsigned int, unsigned int> > > runs_by_bpos;
-  return (runFinder::runsAux(s, runs_by_bpos, algf)); 
+template <class T>
+unsigned int RunFinderContext::countRuns(const T * s, unsigned int n,
+					 enum ALGFLAG algf, RunStats * stats){
+  ResourceScope scope(resource());
+  UIntArray offsets;
+  RunList lists;
+  return (runFinder::runsAux(s, n, offsets, lists, algf, stats, opts)); 
 }
 
-unsigned int runFinder::runsAux(const string & s, 
-				 vector<vector<pair<unsigned int, unsigned int> > > & runs_by_bpos,
-				 enum ALGFLAG algf){
-  unsigned int i, j, k, beginp, endp, p, length, count;
-  std::vector<unsigned int> POS, LEN;
-  LZ77::lpf(s, POS, LEN, algf);
-  length = s.size();
-  runs_by_bpos = vector<vector<pair<unsigned int, unsigned int> > >(length);
-  vector<vector<pair<unsigned int, unsigned int> > > runs_by_epos(length);
+// the naive type 1 scans of a factor compare up to this many symbols per
+// symbol of t and u before they are redone with z-arrays. the naive scans
+// are faster on most factors, but quadratic on long periodic ones.
+static const size_t TYPE1_WORK = 8;
 
-  count = 0;
+// symbols of s from b forwards, and from e backwards
+template <class T>
+class Forward {
+  const T * b;
+public:
+  Forward(const T * b_) : b(b_) {}
+  T operator()(unsigned int i) const { return b[i]; }
+};
 
-  unsigned int tlen, ulen, tbp, prevubp, ubp;
+template <class T>
+class Backward {
+  const T * e;
+public:
+  Backward(const T * e_) : e(e_) {}
+  T operator()(unsigned int i) const { return *(e - 1 - i); }
+};
 
-  ////////////////////////////////////////////////////////////////////////////////
-  // find type 1 runs: 
-  // those that touch the boundary of the begining of u, and ends in u, where u is a lz factor
-  // ubp:     beginnin position of lz factor u
-  // prevubp: beginnin position of previous lz factor
-  ////////////////////////////////////////////////////////////////////////////////
-  for(prevubp = 0, ubp = 1;
-      ubp < length;
-      prevubp=ubp, ubp += max((unsigned int) 1,LEN[ubp])){
-    ulen = max((unsigned int) 1,LEN[ubp]); // length of u
-    tlen = 2 * LEN[prevubp] + ulen;        // maximum length of t that we need to consider.
-    tlen = (tlen > ubp) ? ubp : tlen;      // t can't go past the beggining of the string
-    tbp = ubp - tlen;                      // beginning position of t
-
-    //             tlen              ulen
+// z[k] = lcp of p[0..m) and p[k..m), for k < m. returns the number of
+// symbols compared.
+template <class A>
+static size_t zFunction(const A & p, unsigned int m, unsigned int * z){
+  unsigned int k, x, y, l = 0, r = 0;    // p[l..r) is a prefix of p
+  size_t work = 0;
+  if(m > 0) z[0] = m;
+  for(k = 1; k < m; k++){
+    x = y = (k < r) ? min(z[k - l], r - k) : 0;
+    while(k + x < m && p(x) == p(k + x)) x++;
+    work += x - y + 1;
+    z[k] = x;
+    if(k + x > r){ l = k; r = k + x; }
+  }
+  return work;
+}
+
+// e[k] = lcp of p[0..m) and t[k..tn), for k < en, given the z-function zp
+// of p. returns the number of symbols compared.
+template <class A, class B>
+static size_t zMatch(const A & p, unsigned int m, const unsigned int * zp,
+		     const B & t, unsigned int tn, unsigned int * e, unsigned int en){
+  unsigned int k, x, y, l = 0, r = 0;    // t[l..r) is a prefix of p
+  size_t work = 0;
+  for(k = 0; k < en; k++){
+    x = y = (k < r) ? min(zp[k - l], r - k) : 0;
+    while(x < m && k + x < tn && p(x) == t(k + x)) x++;
+    work += x - y + 1;
+    e[k] = x;
+    if(k + x > r){ l = k; r = k + x; }
+  }
+  return work;
+}
+
+// the extensions of period i of the type 1 scans of factor u (see
+// findType1), compared symbol by symbol. work is the number compared.
+template <class T>
+class DirectExtensions {
+  const T * s;
+  const PackedDNA * dna;
+  unsigned int ubp, tlen, ulen;
+  unsigned int count(unsigned int l){ work += l + 1; return l; }
+public:
+  size_t work;
+  DirectExtensions(const T * s_, const PackedDNA * dna_,
+		   unsigned int ubp_, unsigned int tlen_, unsigned int ulen_)
+    : s(s_), dna(dna_), ubp(ubp_), tlen(tlen_), ulen(ulen_), work(0) {}
+  // runs with a full period in t
+  unsigned int forwardT(unsigned int i){ return count(dnaLce(s, dna, ubp - i, ubp, ulen)); }
+  unsigned int backwardT(unsigned int i){ return count(dnaLcs(s, dna, ubp - i, ubp, tlen - i)); }
+  // runs with a full period in u
+  unsigned int forwardU(unsigned int i){ return count(dnaLce(s, dna, ubp, ubp + i, ulen - i)); }
+  unsigned int backwardU(unsigned int i){ return count(dnaLcs(s, dna, ubp, ubp + i, tlen)); }
+};
+
+// the same extensions from the z-arrays of u and of t reversed, in
+// O(tlen + ulen) time.
+template <class T>
+class ZExtensions {
+  unsigned int tlen, ulen;
+  UIntArray z;
+  unsigned int * zu, * eu, * zt, * et;
+public:
+  size_t work;
+  ZExtensions(const T * s, unsigned int ubp, unsigned int tlen_, unsigned int ulen_)
+    : tlen(tlen_), ulen(ulen_), z(2 * (tlen_ + ulen_)), work(0)
+  {
+    const T * tb = s + ubp - tlen, * ue = s + ubp + ulen;
+    zu = &z[0];                          // u against u
+    eu = zu + ulen;                      // u against t u
+    zt = eu + tlen;                      // t reversed against t reversed
+    et = zt + tlen;                      // t reversed against (t u) reversed
+    Forward<T> u(s + ubp), tu(tb);
+    Backward<T> tr(s + ubp), tur(ue);
+    work += zFunction(u, ulen, zu);
+    work += zMatch(u, ulen, zu, tu, tlen + ulen, eu, tlen);
+    work += zFunction(tr, tlen, zt);
+    work += zMatch(tr, tlen, zt, tur, tlen + ulen, et, ulen);
+  }
+  unsigned int forwardT(unsigned int i){ return eu[tlen - i]; }
+  unsigned int backwardT(unsigned int i){ return (i < tlen) ? zt[i] : 0; }
+  unsigned int forwardU(unsigned int i){ return (i < ulen) ? zu[i] : 0; }
+  unsigned int backwardU(unsigned int i){ return et[ulen - i]; }
+};
+
+// append r to the runs found[begin..) of a factor, unless the last one is
+// the same run (then the smaller period is kept). at the end of the text,
+// the same run is found for all multiples of its period (n/2 times on
+// unary), and only the smallest is kept by the deduplication anyway.
+static inline void pushRun(ResourceVector<run>::type & found, size_t begin, const run & r){
+  if(found.size() > begin && found.back().b_pos == r.b_pos && found.back().e_pos == r.e_pos){
+    if(r.period < found.back().period) found.back() = r;
+    return;
+  }
+  found.push_back(r);
+}
+
+// the type 1 scans of factor u, with the extensions of ext. returns false
+// (with runs appended to found) as soon as ext has compared more than
+// budget symbols.
+template <class T, class E>
+static bool scanType1(const T * s, unsigned int length, unsigned int prevubp,
+		      unsigned int ubp, unsigned int tlen, unsigned int ulen,
+		      E & ext, size_t budget, ResourceVector<run>::type & found){
+  unsigned int i, j, k;
+  size_t begin = found.size();
+
+  //             tlen              ulen
+  //   |--------- t --------|------- u -------|
+  //    tbp                  ubp
+
+  // runs that start in t and end in u, with at least one full period in t.
+  // we also need to include runs which are suffixes of the previous factor
+  for(i = 1; i <= tlen; i++){                                      // checking period = i      
     //   |--------- t --------|------- u -------|
     //    tbp                  ubp
+    //              |--- i ---|
+    //              |- j ->   |- j ->
+    j = ext.forwardT(i);                                           // check forward
+    if((j == ulen) && (ubp + j < length) && (s[ubp-i+j] == s[ubp+j])) 
+      continue; // ignore if run extends beyond u. 
 
-    // Naive implemantation
-    // this makes the algorithm non-linear time, but I'm not sure which would be faster.
-
-    // runs that start in t and end in u, with at least one full period in t.
-    // we also need to include runs which are suffixes of the previous factor
-    for(i = 1; i <= tlen; i++){                                      // checking period = i      
-      //   |--------- t --------|------- u -------|
-      //    tbp                  ubp
-      //              |--- i ---|
-      //              |- j ->   |- j ->
-      for(j = 0; j < ulen && s[ubp-i+j] == s[ubp+j]; j++){};         // check forward      
-      if((j == ulen) && (ubp + j - 1 < length) && (s[ubp-i+j] == s[ubp+j])) 
-	continue; // ignore if run extends beyond u. 
-
-      //   |--------- t --------|------- u -------|
-      //    tbp                  ubp
-      //              |--- i ---|
-      //        <- k -|   <- k -|
-      for(k = 0; i + k < tlen && s[ubp-1-k-i] == s[ubp-1-k]; k++){}; // check backward
-      if((j > 0 || prevubp <= ubp - i - k) // crosses or is a suffix of previous factor
-	 && j+k >= i){
-	// cout << "found: " << "([" << ubp-i-k << "," << ubp+j-1 << "]," << i << ")" << endl;
-	runs_by_epos[ubp+j-1].push_back(make_pair(ubp-i-k,i));
-      }
+    //   |--------- t --------|------- u -------|
+    //    tbp                  ubp
+    //              |--- i ---|
+    //        <- k -|   <- k -|
+    k = ext.backwardT(i);                                          // check backward
+    if((j > 0 || prevubp <= ubp - i - k) // crosses or is a suffix of previous factor
+       && j+k >= i){
+      // cout << "found: " << "([" << ubp-i-k << "," << ubp+j-1 << "]," << i << ")" << endl;
+      pushRun(found, begin, run(ubp-i-k, i, ubp+j-1));
     }
+    if(ext.work > budget) return false;
+  }
 
-    // runs that start in t and end in u, with at least one full period in u.
-    // we also need to include runs which are prefixes of u.
-    for(i = 1; i <= ulen; i++){                                      // checking period = i
-      //   |--------- t --------|------- u -------|
-      //    tbp                  ubp
-      //                        |--- i ---|
-      //                        |- j ->   |- j ->
-      for(j = 0; i + j < ulen && s[ubp+j] == s[ubp+i+j]; j++){} ;    // check forward
-      if(i+j == ulen && (ubp + i + j - 1 < length) && s[ubp+j] == s[ubp+i+j]) 
-	continue; // ignore if run, extends beyond u.
-
-      //   |--------- t --------|------- u -------|
-      //    tbp                  ubp
-      //                        |--- i ---|
-      //                  <- k -|   <- k -|
-      for(k = 0; k < tlen && s[ubp-1-k] == s[ubp+i-1-k]; k++){};     // check backward
-      if(j+k >= i){
-	// cout << "found: " << "([" << ubp-k << "," << ubp+i-1+j << "]," << i << ")" << endl;
-	runs_by_epos[ubp+i-1+j].push_back(make_pair(ubp-k, i)); 
-      }
+  // runs that start in t and end in u, with at least one full period in u.
+  // we also need to include runs which are prefixes of u.
+  for(i = 1; i <= ulen; i++){                                      // checking period = i
+    //   |--------- t --------|------- u -------|
+    //    tbp                  ubp
+    //                        |--- i ---|
+    //                        |- j ->   |- j ->
+    j = ext.forwardU(i);                                           // check forward
+    if(i+j == ulen && (ubp + i + j < length) && s[ubp+j] == s[ubp+i+j]) 
+      continue; // ignore if run, extends beyond u.
+
+    //   |--------- t --------|------- u -------|
+    //    tbp                  ubp
+    //                        |--- i ---|
+    //                  <- k -|   <- k -|
+    k = ext.backwardU(i);                                          // check backward
+    if(j+k >= i){
+      // cout << "found: " << "([" << ubp-k << "," << ubp+i-1+j << "]," << i << ")" << endl;
+      pushRun(found, begin, run(ubp-k, i, ubp+i-1+j));
     }
+    if(ext.work > budget) return false;
+  }
     
-    // note that including the runs that only touch the boundary of u is important
-    // in order to count the run, when the u begins in the middle of a begining of a previously
-    // occurring run. (it is difficult to copy the run, when we don't know where it started)
+  // note that including the runs that only touch the boundary of u is important
+  // in order to count the run, when the u begins in the middle of a begining of a previously
+  // occurring run. (it is difficult to copy the run, when we don't know where it started)
+  return true;
+}
+
+// type 1 runs of lz factor u (after factor prev): those that touch the
+// boundary of the begining of u, and end in u. they are appended to found.
+// returns the number of symbols compared. if dna is not NULL, it is s
+// packed, and the extensions are compared with it.
+template <class T>
+static size_t findType1(const T * s, unsigned int length,
+			const LZFactor & prev, const LZFactor & u,
+			ResourceVector<run>::type & found,
+			const PackedDNA * dna = NULL){
+  unsigned int tlen, ulen, ubp;
+  ubp = u.beg;
+  ulen = max((unsigned int) 1,u.len);      // length of u
+  tlen = 2 * prev.len + ulen;              // maximum length of t that we need to consider.
+  tlen = (tlen > ubp) ? ubp : tlen;        // t can't go past the beggining of the string
+
+  // the naive scans, redone in linear time if they take too long
+  size_t begin = found.size();
+  DirectExtensions<T> direct(s, dna, ubp, tlen, ulen);
+  if(!scanType1(s, length, prev.beg, ubp, tlen, ulen, direct, TYPE1_WORK * (tlen + ulen), found)){
+    found.resize(begin);
+    ZExtensions<T> z(s, ubp, tlen, ulen);
+    scanType1(s, length, prev.beg, ubp, tlen, ulen, z, (size_t) -1, found);
+    return direct.work + z.work;
+  }
+  return direct.work;
+}
+
+// type 2 runs at position ubp+i of lz factor u, 0 < i < ulen-1: those of
+// src[b..e), the runs beginning at u.src+i, that fit in u, appended to out
+// (which may be src). returns the number of runs appended, and adds the
+// number checked to candidates.
+static unsigned int copyFitting(unsigned int length, const LZFactor & u, unsigned int i,
+				const RunList & src, size_t b, size_t e, RunList & out,
+				size_t & candidates){
+  unsigned int endp, count = 0;
+  unsigned int ubp = u.beg;
+  unsigned int ulen = max((unsigned int) 1,u.len);
+  unsigned int prevfactorbp = u.src;      // begin position of previous factor
+  // check the number of runs that started in previous factor that fit in current factor.
+  // we count the run only if it is a proper factor of u, 
+  // or if it is a proper suffix of the last lz factor
+  unsigned int beginp = prevfactorbp + i;
+  size_t j, lastj = b;
+  candidates += e - b;
+  for(j = e; j-- > b;){   // check from shorter runs
+    endp = src[j].first;
+    if(!((endp - beginp + 1 < ulen - i) // a proper factor of u
+	 || ((ubp + ulen >= length) // u is last lz factor
+	     && (ulen - i >= src[j].second * 2) // long enough to be a run
+	     ))){
+      lastj = j+1;
+      break;
+    }
+  }
+  for(j = lastj; j < e; j++){           // push the small enough ones into the new list (smaller last) 
+    endp = min(length - 1, ubp + src[j].first - prevfactorbp);
+    out.push_back(make_pair(endp, src[j].second));
+    count++;
+  }
+  return count;
+}
+
+// type 2 runs of lz factor u: runs that are completely contained in u,
+// copied from its source. runs_by_bpos must hold the runs beginning before
+// u, and those ending in u that touch its beginning. returns the number of
+// runs added, and adds the number checked to candidates.
+static unsigned int copyType2(unsigned int length, const LZFactor & u,
+			      ResourceVector<RunList>::type & runs_by_bpos,
+			      size_t & candidates){
+  unsigned int i, count = 0;
+  unsigned int ulen = max((unsigned int) 1,u.len);
+  if(u.src != u.beg){
+    assert(u.len > 0);
+    for(i = 1; i + 1 < ulen; i++){            // for each position in factor
+      const RunList & l = runs_by_bpos[u.src + i];
+      count += copyFitting(length, u, i, l, 0, l.size(), runs_by_bpos[u.beg + i], candidates);
+    }
+  } else {
+    assert(u.len == 0);
+  }
+  return count;
+}
+
+// order of the type 1 runs: by beginning, then decreasing end, then period.
+// (std::sort, unlike stable_sort, takes no buffer from the heap.)
+static bool beginBefore(const run & a, const run & b){
+  if(a.b_pos != b.b_pos) return a.b_pos < b.b_pos;
+  if(a.e_pos != b.e_pos) return a.e_pos > b.e_pos;
+  return a.period < b.period;
+}
+
+// the packed text of s, if it is dna and mode m allows it (see PackedDNA::pack)
+static const PackedDNA * packDna(PackedDNA & dna, const unsigned char * s, unsigned int n,
+				 enum DNAMODE m){
+  return dna.pack(s, n, m) ? &dna : NULL;
+}
+
+template <class T>
+static const PackedDNA * packDna(PackedDNA &, const T *, unsigned int, enum DNAMODE){
+  return NULL;
+}
+
+template <class T>
+unsigned int runFinder::runsAux(const T * s, unsigned int length,
+				 UIntArray & offsets,
+				 RunList & lists,
+				 enum ALGFLAG algf, RunStats * stats,
+				 const RunOptions & opts){
+  unsigned int f, i, b, r, k, count;
+  LZFactors lz;
+  PackedDNA dna;
+  StageTimer packing(stats, STAGE_TYPE1);  // reported with type 1, as its bytes
+  const PackedDNA * pdna = packDna(dna, s, length, opts.dna);
+  packing.stop();
+  LZ77::factorize(s, length, lz, algf, stats, pdna, opts);
+  LargeArray::assign(offsets, length + 1, opts.alloc);
+  lists.clear();
+  if(length == 0) return 0;
+  StageTimer type1(stats, STAGE_TYPE1);
+  ResourceVector<run>::type found;
+  size_t candidates = 0;                   // for stats
+
+  ////////////////////////////////////////////////////////////////////////////////
+  // find type 1 runs: 
+  // those that touch the boundary of the begining of u, and ends in u, where u is a lz factor
+  ////////////////////////////////////////////////////////////////////////////////
+  for(f = 1; f < lz.size(); f++){
+    candidates += findType1(s, length, lz[f-1], lz[f], found, pdna);
   }
   
-  // count them with sort/uniq by beginpos and endpos
-  // runs_by_bpos[beginp] contains runs (endp, period) in decreasing order of endp
-  for(endp = length-1; endp > 0; endp--){ // bigger ones first
-    for(p = 0; p < runs_by_epos[endp].size(); p++){
-      beginp = runs_by_epos[endp][p].first;
-      if(runs_by_bpos[beginp].empty() || runs_by_bpos[beginp].back().first != endp){
-	runs_by_bpos[beginp].push_back(make_pair(endp, runs_by_epos[endp][p].second));
-	count++;
-      }
+  // count them with sort/uniq by beginpos and endpos.
+  // a run found twice is found at the same boundary, first with its
+  // smallest period, which is kept.
+  sort(found.begin(), found.end(), beginBefore);
+  for(r = k = 0; r < found.size(); r++){
+    if(k == 0 || found[k-1].b_pos != found[r].b_pos || found[k-1].e_pos != found[r].e_pos){
+      found[k++] = found[r];
     }
   }
+  found.resize(k);
+  count = k;
+  
+  if(stats){
+    stats->factors += lz.size();
+    stats->type1Runs += count;
+    stats->candidates[STAGE_TYPE1] += candidates;
+    stats->arrayBytes[STAGE_TYPE1] += found.capacity() * sizeof(run) + dna.bytes();
+  }
+  type1.stop();
   
   ////////////////////////////////////////////////////////////////////////////////
-  // count number of type 2 runs: runs that are completely contained in lz factors
+  // count number of type 2 runs: runs that are completely contained in lz factors.
+  // the lists are built position by position: the type 1 runs beginning at
+  // a position, then its type 2 runs, copied from the finished lists of the
+  // source of the factor.
   ////////////////////////////////////////////////////////////////////////////////
-  for(ubp = 1; ubp < length; ubp += max((unsigned int) 1,LEN[ubp])){
-    ulen = max((unsigned int) 1,LEN[ubp]);
-    unsigned int prevfactorbp = POS[ubp];   // begin position of previous factor
-    if(prevfactorbp != ubp){
-      assert(LEN[ubp] > 0);
-      for(i = 1; i + 1 < ulen; i++){            // for each position in factor
-	// check the number of runs that started in previous factor that fit in current factor.
-	// we count the run only if it is a proper factor of u, 
-	// or if it is a proper suffix of the last lz factor
-	beginp = prevfactorbp + i;
-	unsigned int llen = runs_by_bpos[beginp].size();
-	unsigned int lastj = 0;
-	for(j = llen; j-- > 0;){   // check from shorter runs
-	  endp = runs_by_bpos[beginp][j].first;
-	  // cout << "ubp = " << ubp << " i = " << i << " check: [" << beginp << "," << endp << "] : ulen = " << ulen << endl;
-	  // cout << "period = " << runs_by_bpos[beginp][j].second << endl;
-	  if(!((endp - beginp + 1 < ulen - i) // a proper factor of u
-	       || ((ubp + ulen >= length) // u is last lz factor
-		   && (ulen - i >= runs_by_bpos[beginp][j].second * 2) // long enough to be a run
-		   ))){
-	    // cout << "NO"<< endl;
-	    lastj = j+1;
-	    break;
-	  } else {
-	    // cout << "yes" << endl;
-	  }
-	}
-	for(j = lastj; j < llen; j++){           // push the small enough ones into the new list (smaller last) 
-	  endp = min(length - 1, ubp + runs_by_bpos[beginp][j].first - prevfactorbp);
-	  // cout << "new: [" << ubp+i << "," << endp << "]" << endl;
-	  runs_by_bpos[ubp + i].push_back(make_pair(endp, runs_by_bpos[beginp][j].second));
-	  count++;
-	}
+  StageTimer type2(stats, STAGE_TYPE2);
+  candidates = 0;
+  lists.reserve(count);
+  for(f = r = 0; f < lz.size(); f++){
+    const LZFactor & u = lz[f];
+    unsigned int ulen = max((unsigned int) 1,u.len);
+    assert((u.src != u.beg) == (u.len > 0));
+    for(i = 0; i < ulen; i++){
+      b = u.beg + i;
+      for(; r < found.size() && found[r].b_pos == b; r++){
+	lists.push_back(make_pair(found[r].e_pos, found[r].period));
       }
-    } else {
-      assert(LEN[ubp] == 0);
+      if(u.src != u.beg && i > 0 && i + 1 < ulen){
+	count += copyFitting(length, u, i, lists, offsets[u.src + i], offsets[u.src + i + 1],
+			     lists, candidates);
+      }
+      offsets[b + 1] = lists.size();
     }
   }
+  if(stats){
+    stats->type2Runs += count - found.size();
+    stats->candidates[STAGE_TYPE2] += candidates;
+    stats->arrayBytes[STAGE_TYPE2] += (offsets.capacity() + 2 * lists.capacity()) * sizeof(unsigned int);
+  }
   return count;
 }
+
+// the symbol types of the texts
+template unsigned int runFinder::runsAux(const unsigned char * s, unsigned int length, UIntArray & offsets,
+					  RunList & lists, enum ALGFLAG algf, RunStats * stats,
+					  const RunOptions & opts);
+template unsigned int runFinder::countRuns(const unsigned char * s, unsigned int n,
+					    enum ALGFLAG algf, RunStats * stats);
+template void runFinder::findRuns(const unsigned char * s, unsigned int n, RunSet & runs,
+				  enum ALGFLAG algf, RunStats * stats);
+template unsigned int RunFinderContext::countRuns(const unsigned char * s, unsigned int n,
+						   enum ALGFLAG algf, RunStats * stats);
+template void RunFinderContext::findRuns(const unsigned char * s, unsigned int n, RunSet & runs,
+					 enum ALGFLAG algf, RunStats * stats);
+template unsigned int runFinder::runsAux(const unsigned short * s, unsigned int length, UIntArray & offsets,
+					  RunList & lists, enum ALGFLAG algf, RunStats * stats,
+					  const RunOptions & opts);
+template unsigned int runFinder::countRuns(const unsigned short * s, unsigned int n,
+					    enum ALGFLAG algf, RunStats * stats);
+template void runFinder::findRuns(const unsigned short * s, unsigned int n, RunSet & runs,
+				  enum ALGFLAG algf, RunStats * stats);
+template unsigned int RunFinderContext::countRuns(const unsigned short * s, unsigned int n,
+						   enum ALGFLAG algf, RunStats * stats);
+template void RunFinderContext::findRuns(const unsigned short * s, unsigned int n, RunSet & runs,
+					 enum ALGFLAG algf, RunStats * stats);
+template unsigned int runFinder::runsAux(const unsigned int * s, unsigned int length, UIntArray & offsets,
+					  RunList & lists, enum ALGFLAG algf, RunStats * stats,
+					  const RunOptions & opts);
+template unsigned int runFinder::countRuns(const unsigned int * s, unsigned int n,
+					    enum ALGFLAG algf, RunStats * stats);
+template void runFinder::findRuns(const unsigned int * s, unsigned int n, RunSet & runs,
+				  enum ALGFLAG algf, RunStats * stats);
+template unsigned int RunFinderContext::countRuns(const unsigned int * s, unsigned int n,
+						   enum ALGFLAG algf, RunStats * stats);
+template void RunFinderContext::findRuns(const unsigned int * s, unsigned int n, RunSet & runs,
+					 enum ALGFLAG algf, RunStats * stats);
+
+////////////////////////////////////////////////////////////////////////////////
+
+OnlineRunFinder::OnlineRunFinder()
+  : prev(0, 0, 0), nfactors(0), count(0), finished(false)
+{};
+
+// order of runs found at the same boundary: by end, then beginning, then
+// period, so that of the same run the one with the smallest period is kept.
+static bool endBefore(const run & a, const run & b){
+  if(a.e_pos != b.e_pos) return a.e_pos < b.e_pos;
+  if(a.b_pos != b.b_pos) return a.b_pos < b.b_pos;
+  return a.period < b.period;
+}
+
+// the runs of factor u, which is followed by at least one character
+// unless it is the last one. the type 1 runs of u end after all runs
+// found before, so they are put in front of the lists, which are kept in
+// decreasing order of the end as in runsAux. the type 2 runs of u begin
+// in u, where no runs were found yet.
+void OnlineRunFinder::factor(const LZFactor & u){
+  unsigned int length = text.size();
+  if(nfactors++ > 0){
+    found.clear();
+    findType1(&text[0], length, prev, u, found);
+    sort(found.begin(), found.end(), endBefore);
+    for(unsigned int r = 0; r < found.size(); r++){
+      RunList & l = runs_by_bpos[found[r].b_pos];
+      if(l.empty() || l.front().first != found[r].e_pos){
+	l.insert(l.begin(), make_pair(found[r].e_pos, found[r].period));
+	count++;
+      }
+    }
+    size_t candidates = 0;
+    count += copyType2(length, u, runs_by_bpos, candidates);
+  }
+  prev = u;
+}
+
+void OnlineRunFinder::push(const unsigned char * s, unsigned int n){
+  assert(!finished);
+  text.insert(text.end(), s, s + n);
+  runs_by_bpos.resize(text.size());
+  pending.clear();
+  lz.push(s, n, pending);
+  for(unsigned int f = 0; f < pending.size(); f++) factor(pending[f]);
+}
+
+void OnlineRunFinder::finish(){
+  if(finished) return;
+  finished = true;
+  pending.clear();
+  lz.finish(pending);
+  for(unsigned int f = 0; f < pending.size(); f++) factor(pending[f]);
+}
+
+void OnlineRunFinder::runs(vector<run> & out) const {
+  RunList::const_reverse_iterator itr;
+  out.clear();
+  for(unsigned int beginp = 0; beginp < runs_by_bpos.size(); beginp++){
+    for(itr = runs_by_bpos[beginp].rbegin(); itr != runs_by_bpos[beginp].rend(); itr++){
+      out.push_back(run(beginp, (*itr).second, (*itr).first));
+    }
+  }
+}
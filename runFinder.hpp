@@ -25,6 +25,8 @@
 #define __RUN_FINDER_HPP__
 
 #include "lz77.hpp"
+#include "runSet.hpp"
+#include "runStats.hpp"
 
 // class for runs
 class run {
@@ -36,29 +38,209 @@ public:
   run(int b_pos_, int period_, int e_pos_);
 };
 
-// class for counting runs
+// (endp, period) of runs beginning at the same position
+typedef ResourceVector<std::pair<unsigned int, unsigned int> >::type RunList;
+
+class RunFinderContext;
+
+// class for counting runs.
+//
+// memory budget of the batch engines for a text of length n (bytes,
+// original engine). each stage frees its inputs or writes over them:
+//   suffix sort, rank and lcp:  12n  (SA, rank, lcp)
+//   lpf:                        12n  (POS over rank, LEN over lcp, SA
+//                                     freed once LEN is in text order)
+//   lz factors:                  8n + 12 per factor, then 12 per factor
+//   type 1 runs:                 4n + 12 per factor + 12 per run found
+//                                     (+ 8 per symbol of a long periodic
+//                                     factor and its t, for z-arrays)
+//   type 2 runs:                 4n + 8 per run (24 while the run lists
+//                                     are copied as they grow), + 12 per
+//                                     factor and per type 1 run
+// so the peak is the larger of 12n and 4n + 24 bytes per run (12n up to
+// n/3 runs, 28n at most as there are fewer runs than symbols), plus 12
+// bytes per factor and per type 1 run. the sizes of the arrays of each
+// stage are reported in RunStats::arrayBytes.
+// if dna packing is on (see RunOptions::dna), the packed text takes
+// n/4 more through all stages and is reported with the type 1 runs.
+//
+// the functions below are thin wrappers of a RunFinderContext that takes
+// its memory from the current resource and does not keep it, with the
+// default RunOptions.
 class runFinder {
-  // this function does the actual work
-  static unsigned int runsAux(const std::string & s,
-			      std::vector<std::vector<std::pair<unsigned int, unsigned int> > > &
-			      runs_by_bpos,
-			      enum ALGFLAG algf = USE_LPF_ORIGINAL);  
+  friend class RunFinderContext;
+  // this function does the actual work. the runs (endp, period) beginning
+  // at b are lists[offsets[b]..offsets[b+1]), in decreasing order of endp.
+  // returns the number of runs.
+  template <class T>
+  static unsigned int runsAux(const T * s, unsigned int length,
+			      UIntArray & offsets,
+			      RunList & lists,
+			      enum ALGFLAG algf = USE_LPF_ORIGINAL,
+			      RunStats * stats = NULL,
+			      const RunOptions & opts = RunOptions());
  public:
   
+  // all functions below add the time of each stage to stats if it is not NULL.
+  // the strings s[0..n-1] may have symbols of type T = unsigned char,
+  // unsigned short or unsigned int (tokens, k-mer ids, ...); the wider
+  // ones are suffix sorted by SA-IS, and use the engines of LZ77 that
+  // support them.
+
   // count runs in string s.
   // follows mostly the linear time algorithm by:
   // R. Kolpakov and G. Kucherov,
   // Finding Maximal Repetitions in a Word in Linear Time. FOCS 1999: 596-604
   static unsigned int countRuns(const std::string & s,
-				enum ALGFLAG algf = USE_LPF_ORIGINAL);
+				enum ALGFLAG algf = USE_LPF_ORIGINAL,
+				RunStats * stats = NULL);
+
+  // count runs in string s[0..n-1] (the string is not copied).
+  template <class T>
+  static unsigned int countRuns(const T * s, unsigned int n,
+				enum ALGFLAG algf = USE_LPF_ORIGINAL,
+				RunStats * stats = NULL);
 
   // find all runs in string s.
   // follows mostly the linear time algorithm by:
   // R. Kolpakov and G. Kucherov,
   // Finding Maximal Repetitions in a Word in Linear Time. FOCS 1999: 596-604
+  // runs may have any allocator, e.g. ResourceAllocator<run>.
+  template <class A>
+  static void findRuns(const std::string & s,
+		       std::vector<run, A> & runs,
+		       enum ALGFLAG algf = USE_LPF_ORIGINAL,
+		       RunStats * stats = NULL){
+    findRuns(reinterpret_cast<const unsigned char *>(s.data()), s.size(), runs, algf, stats);
+  }
+
+  // find all runs in string s[0..n-1] (the string is not copied).
+  template <class T, class A>
+  static void findRuns(const T * s, unsigned int n,
+		       std::vector<run, A> & runs,
+		       enum ALGFLAG algf = USE_LPF_ORIGINAL,
+		       RunStats * stats = NULL);
+
+  // find all runs in string s, and store them in a compressed run set.
   static void findRuns(const std::string & s,
-		       std::vector<run> & runs,
-		       enum ALGFLAG algf = USE_LPF_ORIGINAL);  
+		       RunSet & runs,
+		       enum ALGFLAG algf = USE_LPF_ORIGINAL,
+		       RunStats * stats = NULL);
+  template <class T>
+  static void findRuns(const T * s, unsigned int n,
+		       RunSet & runs,
+		       enum ALGFLAG algf = USE_LPF_ORIGINAL,
+		       RunStats * stats = NULL);
+};
+
+// state of run finding that is kept between calls: a pool of the buffers
+// of the engines (suffix, rank, lcp and lpf arrays, lz factors, run lists),
+// which grows to those of the largest call and is reused by the next ones,
+// so that once it is warm a call takes no memory from upstream (except
+// for the thread scratch of the parallel engine). the pool keeps at most
+// maxFree bytes of freed buffers (DEFAULT_MAX_FREE: 64M), so it stays
+// warm for records of up to about two million symbols, and larger ones peak
+// at the budget of runFinder plus maxFree, not at the sum of the arrays of
+// all stages.
+// the context also keeps the RunOptions of its calls, which change how
+// the runs are found but not the results, those of runFinder. not thread
+// safe: use one context per thread.
+//   RunFinderContext ctx;
+//   ctx.options().lzThreads = 4;
+//   for(each record) ctx.findRuns(seq, len, runs);
+class RunFinderContext {
+  PoolResource pool;
+  bool warm;
+  RunOptions opts;
+  RunFinderContext(const RunFinderContext &);
+  RunFinderContext & operator=(const RunFinderContext &);
+  // a context that does not keep its buffers (used by runFinder)
+  explicit RunFinderContext(bool warm_) : warm(warm_) {}
+  MemoryResource * resource(){ return warm ? &pool : MemoryResource::current(); }
+  friend class runFinder;
+public:
+  enum { DEFAULT_MAX_FREE = 1 << 26 };
+  explicit RunFinderContext(MemoryResource * upstream = MemoryResource::heap(),
+			    size_t maxFree = DEFAULT_MAX_FREE)
+    : pool(upstream, maxFree), warm(true) {}
+  // as the functions of runFinder
+  template <class T>
+  unsigned int countRuns(const T * s, unsigned int n,
+			 enum ALGFLAG algf = USE_LPF_ORIGINAL,
+			 RunStats * stats = NULL);
+  template <class T, class A>
+  void findRuns(const T * s, unsigned int n,
+		std::vector<run, A> & runs,
+		enum ALGFLAG algf = USE_LPF_ORIGINAL,
+		RunStats * stats = NULL);
+  template <class T>
+  void findRuns(const T * s, unsigned int n,
+		RunSet & runs,
+		enum ALGFLAG algf = USE_LPF_ORIGINAL,
+		RunStats * stats = NULL);
+  // the settings of the engines of the next calls
+  RunOptions & options(){ return opts; }
+  const RunOptions & options() const { return opts; }
+  // bytes kept from upstream
+  size_t bytes() const { return pool.bytes(); }
+  // number of allocations from upstream so far
+  size_t allocations() const { return pool.allocations(); }
+  // give the buffers back
+  void clear(){ pool.release(); }
+};
+
+template <class T, class A>
+void runFinder::findRuns(const T * s, unsigned int n,
+			 std::vector<run, A> & runs,
+			 enum ALGFLAG algf, RunStats * stats){
+  RunFinderContext ctx(false);
+  ctx.findRuns(s, n, runs, algf, stats);
+}
+
+template <class T, class A>
+void RunFinderContext::findRuns(const T * s, unsigned int n,
+				std::vector<run, A> & runs,
+				enum ALGFLAG algf, RunStats * stats){
+  ResourceScope scope(resource());
+  UIntArray offsets;
+  RunList lists;
+  runs.clear();
+  runs.reserve(runFinder::runsAux(s, n, offsets, lists, algf, stats, opts));
+  for(unsigned int beginp = 0; beginp < n; beginp++){
+    for(unsigned int k = offsets[beginp + 1]; k-- > offsets[beginp];){
+      runs.push_back(run(beginp, lists[k].second, lists[k].first));
+    }
+  }
+}
+
+// finds runs of text that arrives in pieces, from the factors of an
+// OnlineLZ77. the runs of each factor are found as soon as it is complete,
+// i.e. when the character following it has been pushed, and they are final.
+// the runs found after finish() are the same as those of findRuns.
+class OnlineRunFinder {
+  OnlineLZ77 lz;
+  ResourceVector<unsigned char>::type text;
+  ResourceVector<RunList>::type runs_by_bpos;
+  LZFactors pending;
+  ResourceVector<run>::type found;
+  LZFactor prev;
+  unsigned int nfactors;
+  unsigned int count;
+  bool finished;
+  void factor(const LZFactor & u);
+public:
+  OnlineRunFinder();
+  // append s[0..n-1] to the text
+  void push(const unsigned char * s, unsigned int n);
+  // the end of the text
+  void finish();
+  // number of characters pushed
+  unsigned int size() const { return lz.size(); }
+  // number of lz factors and runs found so far
+  unsigned int factors() const { return nfactors; }
+  unsigned int runCount() const { return count; }
+  // the runs found so far, in the order of findRuns
+  void runs(std::vector<run> & out) const;
 };
 
 #endif//__RUN_FINDER_HPP__
@@ -0,0 +1,185 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// runFinderBench.cpp
+// stage level benchmark of run finding on the canonical corpora
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2011 Hideo Bannai
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <iostream>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <getopt.h>
+#include <vector>
+#include "runFinder.hpp"
+#include "corpus.hpp"
+#include "largeArray.hpp"
+#include "packedDna.hpp"
+#include "suffixArray.hpp"
+
+using namespace std;
+
+static void usage(const char * prog){
+  cerr << "usage: " << prog << " [options]" << endl
+       << "  times each stage of run finding for each corpus at sizes 1K, 4K, ..., 1G" << endl
+       << "  and writes the results as JSON to stdout." << endl
+       << "  --engine=NAME            lz factorization: original, kkp, peak, online," << endl
+       << "                           parallel or fm (default: original)" << endl
+       << "  --lz-threads=N           threads of the parallel engine (default: one per processor)" << endl
+       << "  --alloc=POLICY           pages of the large arrays: default, or hugepage," << endl
+       << "                           interleave or local separated by ',' (see largeArray.hpp)" << endl
+       << "  --dna=off|auto|on        pack acgt text 2 bits per base for the comparisons" << endl
+       << "                           (default off; auto: if at most 1/64 of it is other symbols)" << endl
+       << "  --sa=NAME                suffix sorting: auto, divsufsort, sais or doubling" << endl
+       << "                           (default: doubling up to --small-sort, then divsufsort)" << endl
+       << "  --small-sort=N           texts up to N are suffix sorted by doubling by default" << endl
+       << "                           and under auto (default: " << RunOptions().smallSort << ", 0: never)" << endl
+       << "  --corpus=NAME[,NAME...]  corpora to use (default: all)" << endl
+       << "  --min-size=SIZE          smallest size (default: 1K)" << endl
+       << "  --max-size=SIZE          largest size (default: 16M, at most 1G)" << endl
+       << "  --min-time=SECONDS       repeat each measurement for at least this long (default: 0.5)" << endl
+       << "  --seed=N                 seed of the random corpora (default: 1)" << endl
+       << "  --counters               also measure hardware counters of each stage (if available)" << endl
+       << "  SIZE may have a K, M or G suffix." << endl;
+}
+
+int main(int argc, char * argv[]){
+  const size_t MAX_SIZE = 1 << 30;
+  size_t minSize = 1 << 10, maxSize = 1 << 24;
+  double minTime = 0.5;
+  unsigned int seed = 1;
+  bool counters = false;
+  enum ALGFLAG algf = USE_LPF_ORIGINAL;
+  RunOptions opts;
+  vector<enum CORPUS> corpora;
+  for(unsigned int i = 0; i < NUM_CORPORA; i++) corpora.push_back(static_cast<enum CORPUS>(i));
+  static struct option longopts[] = {
+    {"engine",   required_argument, NULL, 'e'},
+    {"lz-threads", required_argument, NULL, 'L'},
+    {"alloc",    required_argument, NULL, 'A'},
+    {"dna",      required_argument, NULL, 'D'},
+    {"sa",       required_argument, NULL, 'a'},
+    {"small-sort", required_argument, NULL, 'S'},
+    {"corpus",   required_argument, NULL, 'c'},
+    {"min-size", required_argument, NULL, 'm'},
+    {"max-size", required_argument, NULL, 'M'},
+    {"min-time", required_argument, NULL, 't'},
+    {"seed",     required_argument, NULL, 's'},
+    {"counters", no_argument,       NULL, 'C'},
+    {"help",     no_argument,       NULL, 'h'},
+    {NULL, 0, NULL, 0}
+  };
+  int c;
+  while((c = getopt_long(argc, argv, "e:L:A:D:a:S:c:m:M:t:s:Ch", longopts, NULL)) != -1){
+    switch(c){
+    case 'e':
+      if(!LZ77::parse(optarg, algf)){ usage(argv[0]); return 1; }
+      break;
+    case 'L':
+      opts.lzThreads = atoi(optarg);
+      break;
+    case 'A':
+      if(!LargeArray::parse(optarg, opts.alloc)){ usage(argv[0]); return 1; }
+      break;
+    case 'D':
+      if(!PackedDNA::parse(optarg, opts.dna)){ usage(argv[0]); return 1; }
+      break;
+    case 'a':
+      if((opts.sorter = SuffixSorter::find(optarg)) == NULL){ usage(argv[0]); return 1; }
+      break;
+    case 'S':
+      opts.smallSort = min((unsigned int) atoi(optarg), (unsigned int) SuffixArrayAux::SMALL_LIMIT);
+      break;
+    case 'c':
+      if(!Corpus::parseList(optarg, corpora)){ usage(argv[0]); return 1; }
+      break;
+    case 'm':
+      if((minSize = Corpus::parseSize(optarg)) == 0){ usage(argv[0]); return 1; }
+      break;
+    case 'M':
+      if((maxSize = Corpus::parseSize(optarg)) == 0 || maxSize > MAX_SIZE){ usage(argv[0]); return 1; }
+      break;
+    case 't':
+      minTime = atof(optarg);
+      break;
+    case 's':
+      seed = atoi(optarg);
+      break;
+    case 'C':
+      counters = true;
+      break;
+    default:
+      usage(argv[0]); return (c == 'h') ? 0 : 1;
+    }
+  }
+
+  PerfCounters perf;
+  if(counters && perf.availableMask() == 0){
+    cerr << "hardware counters are not available, continuing without them" << endl;
+  }
+  // keeps no freed buffers, so that each call allocates as those of runFinder
+  RunFinderContext ctx(MemoryResource::heap(), 0);
+  ctx.options() = opts;
+  string s;
+  bool first = true;
+  printf("{\"benchmark\": \"runFinder\", \"engine\": \"%s\", \"alloc\": \"%s\", \"sa\": \"%s\", "
+	 "\"small_sort\": %u, \"dna\": \"%s\", \"seed\": %u, \"results\": [", LZ77::name(algf),
+	 LargeArray::name(opts.alloc).c_str(), SuffixSorter::nameOf(opts.sorter), opts.smallSort,
+	 PackedDNA::name(opts.dna), seed);
+  for(unsigned int ci = 0; ci < corpora.size(); ci++){
+    for(size_t n = minSize; n <= maxSize; n *= 4){
+      Corpus::generate(corpora[ci], n, s, seed);
+      RunStats stats;
+      unsigned int reps = 0, count = 0;
+      if(counters) stats.perf = &perf;
+      do {
+	count = ctx.countRuns(reinterpret_cast<const unsigned char *>(s.data()), n, algf, &stats);
+	reps++;
+      } while(stats.totalSeconds() < minTime);
+      printf("%s\n  {\"corpus\": \"%s\", \"size\": %lu, \"runs\": %u, \"reps\": %u, \"seconds\": {",
+	     first ? "" : ",", Corpus::name(corpora[ci]), (unsigned long) n, count, reps);
+      for(unsigned int st = 0; st < NUM_STAGES; st++){
+	printf("\"%s\": %.9f, ", RunStats::stageName(static_cast<enum STAGE>(st)),
+	       stats.seconds[st] / reps);
+      }
+      printf("\"total\": %.9f}", stats.totalSeconds() / reps);
+      if(stats.counted){
+	printf(", \"counters\": {");
+	for(unsigned int st = 0; st < NUM_STAGES; st++){
+	  const char * sep = "";
+	  printf("%s\"%s\": {", st ? ", " : "", RunStats::stageName(static_cast<enum STAGE>(st)));
+	  for(unsigned int c = 0; c < NUM_COUNTERS; c++){
+	    if(!(stats.counted & (1 << c))) continue;
+	    printf("%s\"%s\": %llu", sep, PerfCounters::name(static_cast<enum COUNTER>(c)),
+		   stats.counters[st][c] / reps);
+	    sep = ", ";
+	  }
+	  printf("}");
+	}
+	printf("}");
+      }
+      printf("}");
+      fflush(stdout);
+      first = false;
+    }
+  }
+  printf("\n]}\n");
+  return 0;
+}
@@ -0,0 +1,147 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// runFinderComplexity.cpp
+// checks that time and memory of run finding grow linearly with input size
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2011 Hideo Bannai
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <getopt.h>
+#include <sys/time.h>
+#include <vector>
+#include "runFinder.hpp"
+#include "corpus.hpp"
+#include "scaling.hpp"
+#include "bits.h"
+
+using namespace std;
+
+static void usage(const char * prog){
+  cerr << "usage: " << prog << " [options]" << endl
+       << "  runs each engine on each corpus at doubling sizes, fits the exponent e of" << endl
+       << "  time, peak memory allocated and scan work (symbols compared and runs" << endl
+       << "  checked) ~ n^e, and fails (exit status 1) if some exponent exceeds its limit." << endl
+       << "  --engine=NAME              engine to check (default: all)" << endl
+       << "  --corpus=NAME[,NAME...]    corpora to use (default: all)" << endl
+       << "  --min-size=SIZE            smallest size (default: 64K)" << endl
+       << "  --max-size=SIZE            largest size (default: 4M)" << endl
+       << "  --reps=N                   best of N runs for each time (default: 3)" << endl
+       << "  --max-time-exponent=E      limit for time (default: 1.3)" << endl
+       << "  --max-memory-exponent=E    limit for memory and scan work (default: 1.1)" << endl;
+}
+
+int main(int argc, char * argv[]){
+  size_t minSize = 1 << 16, maxSize = 1 << 22;
+  unsigned int reps = 3;
+  double maxTime = 1.3, maxMemory = 1.1;
+  vector<enum CORPUS> corpora;
+  vector<enum ALGFLAG> engines;
+  enum ALGFLAG algf;
+  for(unsigned int i = 0; i < NUM_CORPORA; i++) corpora.push_back(static_cast<enum CORPUS>(i));
+  for(unsigned int i = 0; i < NUM_ALGFLAGS; i++) engines.push_back(static_cast<enum ALGFLAG>(i));
+  static struct option longopts[] = {
+    {"engine",              required_argument, NULL, 'e'},
+    {"corpus",              required_argument, NULL, 'c'},
+    {"min-size",            required_argument, NULL, 'm'},
+    {"max-size",            required_argument, NULL, 'M'},
+    {"reps",                required_argument, NULL, 'r'},
+    {"max-time-exponent",   required_argument, NULL, 't'},
+    {"max-memory-exponent", required_argument, NULL, 'b'},
+    {"help",                no_argument,       NULL, 'h'},
+    {NULL, 0, NULL, 0}
+  };
+  int c;
+  while((c = getopt_long(argc, argv, "e:c:m:M:r:t:b:h", longopts, NULL)) != -1){
+    switch(c){
+    case 'e':
+      if(!LZ77::parse(optarg, algf)){ usage(argv[0]); return 1; }
+      engines.assign(1, algf);
+      break;
+    case 'c':
+      if(!Corpus::parseList(optarg, corpora)){ usage(argv[0]); return 1; }
+      break;
+    case 'm':
+      if((minSize = Corpus::parseSize(optarg)) == 0){ usage(argv[0]); return 1; }
+      break;
+    case 'M':
+      if((maxSize = Corpus::parseSize(optarg)) == 0){ usage(argv[0]); return 1; }
+      break;
+    case 'r':
+      if((reps = atoi(optarg)) == 0){ usage(argv[0]); return 1; }
+      break;
+    case 't':
+      maxTime = atof(optarg);
+      break;
+    case 'b':
+      maxMemory = atof(optarg);
+      break;
+    default:
+      usage(argv[0]); return (c == 'h') ? 0 : 1;
+    }
+  }
+  if(maxSize < 2 * minSize){
+    cerr << "need at least two sizes" << endl;
+    return 1;
+  }
+
+  bool ok = true;
+  string s;
+  printf("%-14s %-16s %8s %8s %8s\n", "engine", "corpus", "time", "memory", "checks");
+  for(unsigned int e = 0; e < engines.size(); e++){
+    for(unsigned int ci = 0; ci < corpora.size(); ci++){
+      vector<double> ns, times, bytes, checks;
+      for(size_t n = minSize; n <= maxSize; n *= 2){
+	Corpus::generate(corpora[ci], n, s);
+	double best = 0;
+	for(unsigned int r = 0; r < reps; r++){
+	  RunStats stats;
+	  CountingResource count(MemoryResource::heap());
+	  struct timeval btv, etv;
+	  gettimeofday(&btv, NULL);
+	  {
+	    ResourceScope scope(&count);
+	    runFinder::countRuns(s, engines[e], &stats);
+	  }
+	  gettimeofday(&etv, NULL);
+	  double t = timediff(btv, etv);
+	  if(r == 0 || t < best) best = t;
+	  if(r == 0){
+	    // the peak of the allocations, not the arrays the engines report,
+	    // and the work alone, without a linear term to dampen it
+	    bytes.push_back(count.peak());
+	    checks.push_back(stats.candidates[STAGE_TYPE1] + stats.candidates[STAGE_TYPE2]);
+	  }
+	}
+	ns.push_back(n);
+	times.push_back(best);
+      }
+      double te = scalingExponent(ns, times);
+      double be = scalingExponent(ns, bytes);
+      double ce = scalingExponent(ns, checks);
+      bool pass = (te <= maxTime && be <= maxMemory && ce <= maxMemory);
+      printf("%-14s %-16s %8.3f %8.3f %8.3f %s\n", LZ77::name(engines[e]), Corpus::name(corpora[ci]),
+	     te, be, ce, pass ? "ok" : "FAIL");
+      fflush(stdout);
+      ok = ok && pass;
+    }
+  }
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,135 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// runFinderGen.cpp
+// writes strings of the benchmark corpora
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2011 Hideo Bannai
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <getopt.h>
+#include <unistd.h>
+#include "corpus.hpp"
+
+using namespace std;
+
+static void usage(const char * prog){
+  cerr << "usage: " << prog << " --corpus=NAME --size=SIZE [options]" << endl
+       << "  writes the string of length SIZE (with K, M or G suffix) of a corpus:" << endl
+       << "  ";
+  for(unsigned int c = 0; c < NUM_CORPORA; c++){
+    cerr << (c ? ", " : "") << Corpus::name(static_cast<enum CORPUS>(c));
+  }
+  cerr << endl
+       << "  --seed=N             seed of the random choices (default: 1)" << endl
+       << "  --alphabet=LETTERS   letters of random and tandem (default: a-z)" << endl
+       << "  --directive=D1,D2..  directive sequence of sturmian, repeated (default: 1,2)" << endl
+       << "  --period=N           unit length of tandem (default: 100)" << endl
+       << "  --mutation=P         substitution probability of tandem (default: 0.01)" << endl
+       << "  --fasta=NAME         write a FASTA record named NAME (default: one raw line)" << endl
+       << "  --output=FILE        write to FILE instead of stdout" << endl;
+}
+
+int main(int argc, char * argv[]){
+  CorpusParams params;
+  enum CORPUS corpus = NUM_CORPORA;
+  size_t size = 0;
+  const char * output = NULL, * fasta = NULL;
+  static struct option longopts[] = {
+    {"corpus",    required_argument, NULL, 'c'},
+    {"size",      required_argument, NULL, 'n'},
+    {"seed",      required_argument, NULL, 's'},
+    {"alphabet",  required_argument, NULL, 'a'},
+    {"directive", required_argument, NULL, 'd'},
+    {"period",    required_argument, NULL, 'p'},
+    {"mutation",  required_argument, NULL, 'm'},
+    {"fasta",     required_argument, NULL, 'f'},
+    {"output",    required_argument, NULL, 'o'},
+    {"help",      no_argument,       NULL, 'h'},
+    {NULL, 0, NULL, 0}
+  };
+  int c;
+  while((c = getopt_long(argc, argv, "c:n:s:a:d:p:m:f:o:h", longopts, NULL)) != -1){
+    switch(c){
+    case 'c':
+      if(!Corpus::parse(optarg, corpus)){ usage(argv[0]); return 1; }
+      break;
+    case 'n':
+      if((size = Corpus::parseSize(optarg)) == 0){ usage(argv[0]); return 1; }
+      break;
+    case 's':
+      params.seed = atoi(optarg);
+      break;
+    case 'a':
+      params.alphabet = optarg;
+      break;
+    case 'd': {
+      char * p = optarg;
+      params.directive.clear();
+      do {
+	unsigned int d = strtoul(p, &p, 10);
+	if(d == 0){ usage(argv[0]); return 1; }
+	params.directive.push_back(d);
+      } while(*p++ == ',');
+      break;
+    }
+    case 'p':
+      if((params.period = atoi(optarg)) == 0){ usage(argv[0]); return 1; }
+      break;
+    case 'm':
+      params.mutation = atof(optarg);
+      break;
+    case 'f':
+      fasta = optarg;
+      break;
+    case 'o':
+      output = optarg;
+      break;
+    default:
+      usage(argv[0]); return (c == 'h') ? 0 : 1;
+    }
+  }
+  if(corpus == NUM_CORPORA || size == 0){
+    usage(argv[0]);
+    return 1;
+  }
+
+  int fd = 1;
+  if(output != NULL && (fd = open(output, O_WRONLY | O_CREAT | O_TRUNC, 0644)) < 0){
+    cerr << output << ": " << strerror(errno) << endl;
+    return 1;
+  }
+  bool ok = true;
+  if(fasta){
+    string header = string(">") + fasta + "\n";
+    ok = (write(fd, header.data(), header.size()) == (ssize_t) header.size())
+      && Corpus::write(corpus, size, fd, params, 60);
+  } else {
+    ok = Corpus::write(corpus, size, fd, params) && write(fd, "\n", 1) == 1;
+  }
+  if(fd != 1 && close(fd) != 0) ok = false;
+  if(!ok){
+    cerr << (output ? output : "stdout") << ": write error" << endl;
+    return 1;
+  }
+  return 0;
+}
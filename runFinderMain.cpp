@@ -1,7 +1,7 @@
 ////////////////////////////////////////////////////////////////////////////////
 //
 // runFinderMain.cpp
-// count runs of each line of stdin
+// count runs of each record of the input files (or stdin)
 //
 ////////////////////////////////////////////////////////////////////////////////
 //
@@ -22,33 +22,155 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include <iostream>
-#include <sys/time.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <getopt.h>
+#include <unistd.h>
 #include "runFinder.hpp"
-#include "bits.h"
+#include "largeArray.hpp"
+#include "packedDna.hpp"
+#include "suffixArray.hpp"
+#include "runIO.hpp"
+#include "pipeline.hpp"
+#include "trace.hpp"
 
 using namespace std;
 
+static void usage(const char * prog){
+  cerr << "usage: " << prog << " [options] [file ...]" << endl
+       << "  counts and lists the runs of each record of the files (default: stdin)." << endl
+       << "  --input=auto|raw|fasta|fastq  input format (raw: whitespace separated strings)" << endl
+       << "  --format=text|tsv|binary      output format (see runIO.hpp)" << endl
+       << "  --output=FILE                 write runs to FILE instead of stdout" << endl
+       << "  --threads=N                   number of compute threads (default: 1)" << endl
+       << "  --engine=NAME                 lz factorization: original, kkp, peak, online," << endl
+       << "                                parallel or fm (default: original)" << endl
+       << "  --lz-threads=N                threads of the parallel engine for each record" << endl
+       << "                                (default: one per processor)" << endl
+       << "  --alloc=POLICY                pages of the large arrays: default, or hugepage," << endl
+       << "                                interleave or local separated by ',' (see largeArray.hpp)" << endl
+       << "  --dna=off|auto|on             pack acgt text 2 bits per base for the comparisons" << endl
+       << "                                (default off; auto: if at most 1/64 of it is other symbols)" << endl
+       << "  --sa=NAME                     suffix sorting: auto, divsufsort, sais or doubling" << endl
+       << "                                (default: doubling up to 512, then divsufsort)" << endl
+       << "  --stats                       write time, array bytes, process peak rss and hardware" << endl
+       << "                                counters (if available) of each stage as JSON to stderr," << endl
+       << "                                one line per record (see runStats.hpp)" << endl
+       << "                                and one for all records" << endl
+       << "  --trace=FILE                  write a timeline of the threads to FILE" << endl
+       << "                                (chrome trace JSON, for chrome://tracing or perfetto)" << endl;
+}
+
 int main(int argc, char * argv[]){
-  string s;
-  runFinder rc;
-  vector<run> runs;
-  vector<unsigned int> POS, LEN;
-  unsigned int i, length;
-  struct timeval btv, etv;  
-  while(cin >> s){
-    gettimeofday(&btv, NULL);
-    length = s.size();
-    rc.findRuns(s, runs);
-    cout << "# of runs = " << runs.size() << endl;
-    for(i = 0; i < runs.size(); i++){
-      cout << "([" 
-	   << runs[i].b_pos << ","
-	   << runs[i].e_pos << "],"
-	   << runs[i].period << ")" 
-	   << endl;
+  enum SEQFORMAT fmt = SEQ_AUTO;
+  enum RUNFORMAT ofmt = RUNS_TEXT;
+  const char * output = NULL;
+  unsigned int nthreads = 1;
+  enum ALGFLAG algf = USE_LPF_ORIGINAL;
+  RunOptions opts;
+  bool stats = false;
+  const char * trace = NULL;
+  static struct option longopts[] = {
+    {"input",  required_argument, NULL, 'i'},
+    {"format", required_argument, NULL, 'f'},
+    {"output", required_argument, NULL, 'o'},
+    {"threads", required_argument, NULL, 't'},
+    {"engine", required_argument, NULL, 'e'},
+    {"lz-threads", required_argument, NULL, 'L'},
+    {"alloc",  required_argument, NULL, 'A'},
+    {"dna",    required_argument, NULL, 'D'},
+    {"sa",     required_argument, NULL, 'a'},
+    {"stats",  no_argument,       NULL, 's'},
+    {"trace",  required_argument, NULL, 'T'},
+    {"help",   no_argument,       NULL, 'h'},
+    {NULL, 0, NULL, 0}
+  };
+  int c;
+  while((c = getopt_long(argc, argv, "i:f:o:t:e:L:A:D:a:sT:h", longopts, NULL)) != -1){
+    switch(c){
+    case 'i':
+      if(!strcmp(optarg, "auto")) fmt = SEQ_AUTO;
+      else if(!strcmp(optarg, "raw")) fmt = SEQ_RAW;
+      else if(!strcmp(optarg, "fasta")) fmt = SEQ_FASTA;
+      else if(!strcmp(optarg, "fastq")) fmt = SEQ_FASTQ;
+      else { usage(argv[0]); return 1; }
+      break;
+    case 'f':
+      if(!strcmp(optarg, "text")) ofmt = RUNS_TEXT;
+      else if(!strcmp(optarg, "tsv")) ofmt = RUNS_TSV;
+      else if(!strcmp(optarg, "binary")) ofmt = RUNS_BINARY;
+      else { usage(argv[0]); return 1; }
+      break;
+    case 'o':
+      output = optarg;
+      break;
+    case 't':
+      nthreads = atoi(optarg);
+      if(nthreads == 0){ usage(argv[0]); return 1; }
+      break;
+    case 'e':
+      if(!LZ77::parse(optarg, algf)){ usage(argv[0]); return 1; }
+      break;
+    case 'L':
+      opts.lzThreads = atoi(optarg);
+      break;
+    case 'A':
+      if(!LargeArray::parse(optarg, opts.alloc)){ usage(argv[0]); return 1; }
+      break;
+    case 'D':
+      if(!PackedDNA::parse(optarg, opts.dna)){ usage(argv[0]); return 1; }
+      break;
+    case 'a':
+      if((opts.sorter = SuffixSorter::find(optarg)) == NULL){ usage(argv[0]); return 1; }
+      break;
+    case 's':
+      stats = true;
+      break;
+    case 'T':
+      if(!Trace::available()){
+	cerr << "tracing is not available in this build" << endl;
+	return 1;
+      }
+      trace = optarg;
+      break;
+    default:
+      usage(argv[0]); return (c == 'h') ? 0 : 1;
     }
-    gettimeofday(&etv, NULL);
-    printf("Total Time: approx %.5f seconds\n", timediff(btv, etv));
   }
-  return 0;
+  vector<const char *> files(argv + optind, argv + argc);
+  if(files.empty()) files.push_back("-");
+
+  int ofd = 1;
+  if(output != NULL && (ofd = open(output, O_WRONLY | O_CREAT | O_TRUNC, 0644)) < 0){
+    cerr << output << ": " << strerror(errno) << endl;
+    return 1;
+  }
+  RunWriter writer(ofd, ofmt);
+  writer.writeHeader();
+
+  if(trace) Trace::start();
+  RunPipeline pipeline(writer, nthreads, algf);
+  pipeline.setInputFormat(fmt);
+  pipeline.setOptions(opts);
+  if(stats) pipeline.setStatsOutput(stderr);
+  bool ok = pipeline.process(files);
+  if(!ok) cerr << pipeline.error() << endl;
+  if(stats){
+    fprintf(stderr, "{\"aggregate\": {\"records\": %lu, \"stats\": %s}}\n",
+	    (unsigned long) pipeline.records(), pipeline.totalStats().json().c_str());
+  }
+  writer.flush();
+  if(trace && !Trace::write(trace)){
+    cerr << trace << ": " << strerror(errno) << endl;
+    ok = false;
+  }
+  if(writer.fail()){
+    cerr << (output ? output : "stdout") << ": write error" << endl;
+    return 1;
+  }
+  if(ofd != 1) close(ofd);
+  return ok ? 0 : 1;
 }
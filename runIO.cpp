@@ -0,0 +1,272 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// runIO.cpp
+// buffered output of runs in text, tsv and binary formats,
+// and a reader for the binary format
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2011 Hideo Bannai
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "runIO.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+
+using namespace std;
+
+static const char MAGIC[4] = { 'R', 'U', 'N', 'F' };
+static const unsigned char VERSION = 1;
+
+////////////////////////////////////////////////////////////////////////////////
+
+RunWriter::RunWriter(int fd_, enum RUNFORMAT fmt_, size_t bufsize)
+  : fd(fd_), fmt(fmt_), cap(bufsize < 64 ? 64 : bufsize), used(0),
+    nrecords(0), failed(false)
+{
+  buf = new char[cap];
+}
+
+RunWriter::~RunWriter(){
+  flush();
+  delete [] buf;
+}
+
+void RunWriter::flush(){
+  size_t off = 0;
+  while(off < used && !failed){
+    ssize_t r = ::write(fd, buf + off, used - off);
+    if(r < 0){
+      if(errno == EINTR) continue;
+      failed = true;
+    } else {
+      off += r;
+    }
+  }
+  used = 0;
+}
+
+void RunWriter::write(const char * p, size_t n){
+  if(n > cap - used){
+    flush();
+    if(n > cap){                        // too large to buffer
+      size_t off = 0;
+      while(off < n && !failed){
+	ssize_t r = ::write(fd, p + off, n - off);
+	if(r < 0){
+	  if(errno == EINTR) continue;
+	  failed = true;
+	} else {
+	  off += r;
+	}
+      }
+      return;
+    }
+  }
+  memcpy(buf + used, p, n);
+  used += n;
+}
+
+// decimal representation of v (at most 20 digits; caller reserves room)
+void RunWriter::putUInt(unsigned long long v){
+  char tmp[20];
+  int k = 0;
+  do { tmp[k++] = '0' + (v % 10); v /= 10; } while(v);
+  while(k > 0) buf[used++] = tmp[--k];
+}
+
+// unsigned LEB128 (at most 10 bytes; caller reserves room)
+void RunWriter::putVarint(unsigned long long v){
+  while(v >= 0x80){
+    buf[used++] = static_cast<char>((v & 0x7f) | 0x80);
+    v >>= 7;
+  }
+  buf[used++] = static_cast<char>(v);
+}
+
+void RunWriter::writeHeader(){
+  switch(fmt){
+  case RUNS_BINARY: {
+    char h[8] = { MAGIC[0], MAGIC[1], MAGIC[2], MAGIC[3], (char) VERSION, 0, 0, 0 };
+    write(h, sizeof(h));
+    break;
+  }
+  case RUNS_TSV: {
+    static const char h[] = "#name\tb_pos\te_pos\tperiod\n";
+    write(h, sizeof(h) - 1);
+    break;
+  }
+  default:
+    break;
+  }
+}
+
+void RunWriter::writeRecord(const char * name, size_t name_len, unsigned int seq_len,
+			    const vector<run> & runs){
+  unsigned int i, prev;
+  switch(fmt){
+  case RUNS_TEXT: {
+    static const char h[] = "# of runs = ";
+    if(name_len > 0){
+      reserve(1); buf[used++] = '>';
+      write(name, name_len);
+      reserve(1); buf[used++] = '\n';
+    }
+    reserve(sizeof(h) + 21);
+    memcpy(buf + used, h, sizeof(h) - 1); used += sizeof(h) - 1;
+    putUInt(runs.size()); buf[used++] = '\n';
+    for(i = 0; i < runs.size(); i++){
+      reserve(3 * 20 + 8);
+      buf[used++] = '('; buf[used++] = '[';
+      putUInt(runs[i].b_pos); buf[used++] = ',';
+      putUInt(runs[i].e_pos); buf[used++] = ']'; buf[used++] = ',';
+      putUInt(runs[i].period); buf[used++] = ')'; buf[used++] = '\n';
+    }
+    break;
+  }
+  case RUNS_TSV: {
+    // the record name is repeated on every line
+    char num[21];
+    if(name_len == 0){
+      unsigned long long v = nrecords;
+      int k = sizeof(num);
+      do { num[--k] = '0' + (v % 10); v /= 10; } while(v);
+      name = num + k;
+      name_len = sizeof(num) - k;
+    }
+    for(i = 0; i < runs.size(); i++){
+      write(name, name_len);
+      reserve(3 * 20 + 4);
+      buf[used++] = '\t'; putUInt(runs[i].b_pos);
+      buf[used++] = '\t'; putUInt(runs[i].e_pos);
+      buf[used++] = '\t'; putUInt(runs[i].period);
+      buf[used++] = '\n';
+    }
+    break;
+  }
+  case RUNS_BINARY: {
+    reserve(10);
+    putVarint(name_len);
+    write(name, name_len);
+    reserve(20);
+    putVarint(seq_len);
+    putVarint(runs.size());
+    for(prev = 0, i = 0; i < runs.size(); i++){
+      reserve(30);
+      putVarint(runs[i].b_pos - prev);
+      putVarint(runs[i].e_pos - runs[i].b_pos + 1);
+      putVarint(runs[i].period);
+      prev = runs[i].b_pos;
+    }
+    break;
+  }
+  }
+  nrecords++;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+RunReader::RunReader(int fd_, size_t bufsize)
+  : fd(fd_), cap(bufsize < 64 ? 64 : bufsize), pos(0), end(0), eof(false)
+{
+  buf = new unsigned char[cap];
+}
+
+RunReader::~RunReader(){
+  delete [] buf;
+}
+
+bool RunReader::fill(){
+  if(eof) return false;
+  pos = end = 0;
+  while(true){
+    ssize_t r = ::read(fd, buf, cap);
+    if(r < 0){
+      if(errno == EINTR) continue;
+      err = strerror(errno);
+      eof = true;
+      return false;
+    }
+    if(r == 0){ eof = true; return false; }
+    end = r;
+    return true;
+  }
+}
+
+bool RunReader::getByte(unsigned char & c){
+  if(pos == end && !fill()) return false;
+  c = buf[pos++];
+  return true;
+}
+
+bool RunReader::getVarint(unsigned long long & v){
+  unsigned char c;
+  unsigned int shift = 0;
+  v = 0;
+  do {
+    if(!getByte(c) || shift > 63){
+      if(err.empty()) err = "truncated or corrupt varint";
+      return false;
+    }
+    v |= (unsigned long long) (c & 0x7f) << shift;
+    shift += 7;
+  } while(c & 0x80);
+  return true;
+}
+
+bool RunReader::readHeader(){
+  unsigned char h[8];
+  for(unsigned int i = 0; i < sizeof(h); i++){
+    if(!getByte(h[i])){
+      if(err.empty()) err = "truncated header";
+      return false;
+    }
+  }
+  if(memcmp(h, MAGIC, sizeof(MAGIC)) != 0){ err = "not a binary run file"; return false; }
+  if(h[4] != VERSION){ err = "unsupported binary run file version"; return false; }
+  return true;
+}
+
+bool RunReader::readRecord(string & name, unsigned int & seq_len, vector<run> & runs){
+  unsigned long long nlen, slen, count, d, l, p, b = 0;
+  unsigned char c;
+  runs.clear();
+  name.clear();
+  if(pos == end && !fill()) return false;  // clean end of input
+  if(!getVarint(nlen)) return false;
+  for(unsigned long long i = 0; i < nlen; i++){
+    if(!getByte(c)){ err = "truncated record name"; return false; }
+    name.push_back(c);
+  }
+  if(!getVarint(slen) || !getVarint(count)) return false;
+  if(slen > 0xffffffffULL){ err = "sequence length out of range"; return false; }
+  if(count > slen){ err = "more runs than symbols"; return false; }
+  seq_len = slen;
+  // count may still be corrupt: reserve only for the runs that fit in the
+  // buffer (3 bytes each at least), and grow while reading the rest
+  runs.reserve(min(count, (unsigned long long) (end - pos) / 3));
+  for(unsigned long long i = 0; i < count; i++){
+    if(!getVarint(d) || !getVarint(l) || !getVarint(p)) return false;
+    if(d > slen - b || l == 0 || l > slen - b - d){ err = "run out of range"; return false; }
+    if(p == 0 || p > l / 2){ err = "run period out of range"; return false; }
+    b += d;
+    runs.push_back(run(b, p, b + l - 1));
+  }
+  return true;
+}
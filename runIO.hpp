@@ -0,0 +1,117 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// runIO.hpp
+// buffered output of runs in text, tsv and binary formats,
+// and a reader for the binary format
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2011 Hideo Bannai
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __RUN_IO_HPP__
+#define __RUN_IO_HPP__
+
+#include <string>
+#include <vector>
+#include "runFinder.hpp"
+
+// Output formats
+// -----------------------------------------------------------------------
+// RUNS_TEXT:   the original format. for each record:
+//                >name                  (only for named records)
+//                # of runs = <count>
+//                ([b_pos,e_pos],period) (one line per run)
+// RUNS_TSV:    a header line "#name\tb_pos\te_pos\tperiod", then one
+//              line per run. unnamed records are named by their
+//              0-based index in the output.
+// RUNS_BINARY: a file header followed by one block per record.
+//              all integers are unsigned LEB128 varints
+//              (7 bits per byte, least significant group first,
+//              high bit set on all but the last byte).
+//                file header: "RUNF" (4 bytes), version (1 byte, = 1),
+//                             3 bytes reserved (= 0)
+//                record:      name length, name bytes,
+//                             sequence length, number of runs,
+//                             then for each run in increasing order of
+//                             b_pos (as produced by runFinder::findRuns):
+//                               b_pos - (b_pos of previous run, or 0)
+//                               e_pos - b_pos + 1   (length of run)
+//                               period
+// -----------------------------------------------------------------------
+enum RUNFORMAT {
+  RUNS_TEXT,
+  RUNS_TSV,
+  RUNS_BINARY,
+};
+
+// buffered writer of runs to a file descriptor.
+// nothing is flushed until the buffer fills, flush() is called, or
+// the writer is destroyed.
+class RunWriter {
+  int fd;
+  enum RUNFORMAT fmt;
+  char * buf;
+  size_t cap, used;
+  unsigned long long nrecords;
+  bool failed;
+  void write(const char * p, size_t n);
+  void putUInt(unsigned long long v);
+  void putVarint(unsigned long long v);
+  void reserve(size_t n){ if(cap - used < n) flush(); }
+  RunWriter(const RunWriter &);
+  RunWriter & operator=(const RunWriter &);
+public:
+  static const size_t DEFAULT_BUFFER_SIZE = 1 << 22;
+  RunWriter(int fd_, enum RUNFORMAT fmt_, size_t bufsize = DEFAULT_BUFFER_SIZE);
+  ~RunWriter();
+  // write the file header (binary and tsv). call once, before any record.
+  void writeHeader();
+  // write the runs of one record (runs in increasing order of b_pos).
+  void writeRecord(const char * name, size_t name_len, unsigned int seq_len,
+		   const std::vector<run> & runs);
+  // write an arbitrary string as is.
+  void writeText(const char * p, size_t n){ write(p, n); }
+  void flush();
+  // true if some write to the file descriptor failed.
+  bool fail() const { return failed; }
+  enum RUNFORMAT format() const { return fmt; }
+};
+
+// reader of the binary format
+class RunReader {
+  int fd;
+  unsigned char * buf;
+  size_t cap, pos, end;
+  bool eof;
+  std::string err;
+  bool fill();
+  bool getByte(unsigned char & c);
+  bool getVarint(unsigned long long & v);
+  RunReader(const RunReader &);
+  RunReader & operator=(const RunReader &);
+public:
+  RunReader(int fd_, size_t bufsize = 1 << 20);
+  ~RunReader();
+  // read and check the file header.
+  bool readHeader();
+  // read the next record. returns false at the end of input or on error
+  // (error() is non-empty in the latter case).
+  bool readRecord(std::string & name, unsigned int & seq_len, std::vector<run> & runs);
+  const std::string & error() const { return err; }
+};
+
+#endif//__RUN_IO_HPP__
@@ -0,0 +1,51 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// runOptions.hpp
+// settings of the engines of run finding
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2011 Hideo Bannai
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __RUN_OPTIONS_HPP__
+#define __RUN_OPTIONS_HPP__
+
+#include "packedDna.hpp"
+
+class SuffixSorter;
+
+// settings of the engines, passed down with each call (a RunFinderContext
+// keeps them, see RunFinderContext::options) instead of being process
+// wide, so that calls in different threads may use different ones.
+// the defaults are those of the functions of runFinder.
+class RunOptions {
+public:
+  const SuffixSorter * sorter;  // suffix sorting of byte texts (NULL: doubling
+                                // up to smallSort, divsufsort above; see
+                                // suffixArray.hpp)
+  unsigned int smallSort;       // texts up to this length are sorted by doubling
+                                // by default and under auto (at most
+                                // SuffixArrayAux::SMALL_LIMIT, 0: never)
+  unsigned int lzThreads;       // threads of USE_LPF_PARALLEL. 0: one per
+                                // processor, but fewer for short strings
+  enum DNAMODE dna;             // when the text is packed (see PackedDNA::pack)
+  unsigned int alloc;           // placement of the pages of the large arrays
+                                // (ALLOCFLAGs, see largeArray.hpp)
+  RunOptions() : sorter(NULL), smallSort(512), lzThreads(0), dna(DNA_OFF), alloc(0) {}
+};
+
+#endif//__RUN_OPTIONS_HPP__
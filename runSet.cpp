@@ -0,0 +1,186 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// runSet.cpp
+// compressed set of runs
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2011 Hideo Bannai
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "runSet.hpp"
+#include "runFinder.hpp"
+#include <cassert>
+
+using namespace std;
+
+// number of bits needed to represent v
+static inline unsigned int bitWidth(unsigned long long v){
+  return v ? 64 - __builtin_clzll(v) : 0;
+}
+
+// position of the r-th (0-based) set bit of w
+static inline unsigned int selectInWord(unsigned long long w, unsigned int r){
+  while(r-- > 0) w &= w - 1;
+  return __builtin_ctzll(w);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void PackedArray::init(size_t n, unsigned int width_){
+  width = width_;
+  w.assign((n * width + 63) / 64 + 1, 0);
+}
+
+void PackedArray::set(size_t i, unsigned long long v){
+  if(width == 0) return;
+  size_t b = i * width, k = b >> 6, o = b & 63;
+  unsigned long long mask = (width == 64) ? ~0ULL : ((1ULL << width) - 1);
+  v &= mask;
+  w[k] = (w[k] & ~(mask << o)) | (v << o);
+  if(o + width > 64){
+    w[k+1] = (w[k+1] & ~(mask >> (64 - o))) | (v >> (64 - o));
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+RunSet::RunSet()
+  : n(0), m(0), lbits(0), filled(0), lastb(0)
+{};
+
+void RunSet::clear(){
+  init(0, 0, 0, 0);
+}
+
+void RunSet::init(unsigned int n_, size_t count,
+		  unsigned int max_period, unsigned int max_excess){
+  n = n_;
+  m = count;
+  lbits = (m > 0 && n > m) ? bitWidth(n / m) - 1 : 0;
+  low.init(m, lbits);
+  period.init(m, bitWidth(max_period));
+  excess.init(m, bitWidth(max_excess));
+  high.assign((m + (n >> lbits) + 1 + 63) / 64 + 1, 0);
+  sel1.clear();
+  sel0.clear();
+  filled = 0;
+  lastb = 0;
+  if(m == 0) buildSelect();
+}
+
+void RunSet::push_back(unsigned int b_pos, unsigned int period_, unsigned int e_pos){
+  assert(filled < m && b_pos >= lastb && b_pos < n);
+  assert(e_pos - b_pos + 1 >= 2 * period_);
+  size_t hp = (b_pos >> lbits) + filled;
+  high[hp >> 6] |= 1ULL << (hp & 63);
+  low.set(filled, b_pos);
+  period.set(filled, period_);
+  excess.set(filled, e_pos - b_pos + 1 - 2 * period_);
+  lastb = b_pos;
+  if(++filled == m) buildSelect();
+}
+
+void RunSet::buildSelect(){
+  size_t nbits = m + (n >> lbits) + 1, ones = 0, zeros = 0, i;
+  for(i = 0; i < nbits; i++){
+    if((high[i >> 6] >> (i & 63)) & 1){
+      if(ones++ % SAMPLE == 0) sel1.push_back(i);
+    } else {
+      if(zeros++ % SAMPLE == 0) sel0.push_back(i);
+    }
+  }
+}
+
+size_t RunSet::select1(size_t k) const {
+  size_t p = sel1[k / SAMPLE], r = k % SAMPLE, wi = p >> 6;
+  unsigned long long w = high[wi] & (~0ULL << (p & 63));
+  while(true){
+    size_t c = __builtin_popcountll(w);
+    if(r < c) return (wi << 6) + selectInWord(w, r);
+    r -= c;
+    w = high[++wi];
+  }
+}
+
+size_t RunSet::select0(size_t k) const {
+  size_t p = sel0[k / SAMPLE], r = k % SAMPLE, wi = p >> 6;
+  unsigned long long w = ~high[wi] & (~0ULL << (p & 63));
+  while(true){
+    size_t c = __builtin_popcountll(w);
+    if(r < c) return (wi << 6) + selectInWord(w, r);
+    r -= c;
+    w = ~high[++wi];
+  }
+}
+
+size_t RunSet::bytes() const {
+  return sizeof(*this) + low.bytes() + period.bytes() + excess.bytes()
+    + high.size() * sizeof(unsigned long long)
+    + (sel1.size() + sel0.size()) * sizeof(size_t);
+}
+
+unsigned int RunSet::beginPos(size_t i) const {
+  return ((select1(i) - i) << lbits) | low.get(i);
+}
+
+run RunSet::operator[](size_t i) const {
+  return *iteratorAt(i);
+}
+
+size_t RunSet::lowerBound(unsigned int pos) const {
+  if(pos >= n) return m;
+  size_t h = pos >> lbits;
+  size_t p = (h == 0) ? 0 : select0(h - 1) + 1;   // start of bucket h
+  size_t i = p - h;                               // number of ones before p
+  // scan the bucket; everything after it is larger
+  for(; (high[p >> 6] >> (p & 63)) & 1; p++, i++){
+    if(((h << lbits) | low.get(i)) >= pos) break;
+  }
+  return i;
+}
+
+RunSet::const_iterator RunSet::iteratorAt(size_t i) const {
+  if(i >= m) return end();
+  return const_iterator(this, i, select1(i));
+}
+
+pair<RunSet::const_iterator, RunSet::const_iterator>
+RunSet::startingIn(unsigned int i, unsigned int j) const {
+  size_t first = lowerBound(i), last = (j > i) ? lowerBound(j) : first;
+  return make_pair(iteratorAt(first), iteratorAt(last));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+unsigned int RunSet::const_iterator::beginPos() const {
+  return ((hp - i) << rs->lbits) | rs->low.get(i);
+}
+
+run RunSet::const_iterator::operator*() const {
+  unsigned int b = beginPos();
+  unsigned int p = rs->period.get(i);
+  return run(b, p, b + 2 * p + rs->excess.get(i) - 1);
+}
+
+RunSet::const_iterator & RunSet::const_iterator::operator++(){
+  if(++i >= rs->m){ i = rs->m; hp = 0; return *this; }
+  size_t wi = (hp + 1) >> 6;
+  unsigned long long w = rs->high[wi] & (~0ULL << ((hp + 1) & 63));
+  while(w == 0) w = rs->high[++wi];
+  hp = (wi << 6) + __builtin_ctzll(w);
+  return *this;
+}
@@ -0,0 +1,128 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// runSet.hpp
+// compressed set of runs
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2011 Hideo Bannai
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __RUN_SET_HPP__
+#define __RUN_SET_HPP__
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+#include "memoryResource.hpp"
+
+class run;
+
+// array of fixed width unsigned integers packed into 64 bit words
+class PackedArray {
+  ResourceVector<unsigned long long>::type w;
+  unsigned int width;
+public:
+  PackedArray() : width(0) {}
+  void init(size_t n, unsigned int width_);
+  unsigned int bitWidth() const { return width; }
+  size_t bytes() const { return w.size() * sizeof(unsigned long long); }
+  unsigned long long get(size_t i) const {
+    if(width == 0) return 0;
+    size_t b = i * width, k = b >> 6, o = b & 63;
+    unsigned long long v = w[k] >> o;
+    if(o + width > 64) v |= w[k+1] << (64 - o);
+    return (width == 64) ? v : (v & ((1ULL << width) - 1));
+  }
+  void set(size_t i, unsigned long long v);
+};
+
+// set of runs, sorted in increasing order of begin position
+// (and end position for runs with the same begin position),
+// as produced by runFinder::findRuns.
+// -----------------------------------------------------------------------
+// begin positions are Elias-Fano coded: the low l bits of each are
+// stored in a packed array and the high bits in unary, as a bit vector
+// of size + (n >> l) + 1 bits with sampled select support.
+// periods are stored with the bit width of the largest period, and the
+// lengths as the excess over two periods (length - 2 * period), which is
+// usually much smaller than the length itself.
+// this amounts to about 2 + log(n/size) bits per run for the begin
+// positions, instead of 96 bits for a run object.
+// -----------------------------------------------------------------------
+class RunSet {
+  unsigned int n;                       // length of string (universe)
+  size_t m;                             // number of runs
+  unsigned int lbits;                   // number of low bits
+  PackedArray low, period, excess;
+  ResourceVector<unsigned long long>::type high;  // unary coded high bits
+  ResourceVector<size_t>::type sel1, sel0;        // position of every SAMPLE-th one/zero
+  size_t filled;
+  unsigned int lastb;
+  static const size_t SAMPLE = 256;
+  size_t select1(size_t k) const;
+  size_t select0(size_t k) const;
+  void buildSelect();
+public:
+  RunSet();
+  // prepare for count runs on a string of length n_,
+  // whose periods and excesses (length - 2 * period) are at most
+  // max_period and max_excess.
+  void init(unsigned int n_, size_t count,
+	    unsigned int max_period, unsigned int max_excess);
+  // append a run. runs must be appended in sorted order, and exactly
+  // count (as given to init) must be appended before the set is used.
+  void push_back(unsigned int b_pos, unsigned int period_, unsigned int e_pos);
+  void clear();
+
+  size_t size() const { return m; }
+  bool empty() const { return m == 0; }
+  // length of the string the runs are on
+  unsigned int length() const { return n; }
+  // memory used in bytes
+  size_t bytes() const;
+
+  // random access
+  run operator[](size_t i) const;
+  unsigned int beginPos(size_t i) const;
+  // index of the first run whose begin position is >= pos
+  size_t lowerBound(unsigned int pos) const;
+
+  // sequential iteration
+  class const_iterator {
+    const RunSet * rs;
+    size_t i;                            // index of run
+    size_t hp;                           // position of its one in high
+    friend class RunSet;
+    const_iterator(const RunSet * rs_, size_t i_, size_t hp_)
+      : rs(rs_), i(i_), hp(hp_) {}
+  public:
+    const_iterator() : rs(NULL), i(0), hp(0) {}
+    run operator*() const;
+    unsigned int beginPos() const;
+    size_t index() const { return i; }
+    const_iterator & operator++();
+    bool operator==(const const_iterator & o) const { return i == o.i; }
+    bool operator!=(const const_iterator & o) const { return i != o.i; }
+  };
+  const_iterator begin() const { return iteratorAt(0); }
+  const_iterator end() const { return const_iterator(this, m, 0); }
+  const_iterator iteratorAt(size_t i) const;
+  // runs whose begin positions are in [i, j)
+  std::pair<const_iterator, const_iterator> startingIn(unsigned int i, unsigned int j) const;
+};
+
+#endif//__RUN_SET_HPP__
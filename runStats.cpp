@@ -0,0 +1,151 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// runStats.cpp
+// per stage statistics of run finding
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2011 Hideo Bannai
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "runStats.hpp"
+#include "bits.h"
+#include <cstdio>
+#include <algorithm>
+#include <sys/resource.h>
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////////////
+
+RunStats::RunStats()
+  : perf(NULL)
+{
+  clear();
+}
+
+void RunStats::clear(){
+  for(unsigned int s = 0; s < NUM_STAGES; s++){
+    seconds[s] = 0;
+    arrayBytes[s] = processPeakRss[s] = candidates[s] = 0;
+    for(unsigned int c = 0; c < NUM_COUNTERS; c++) counters[s][c] = 0;
+  }
+  factors = type1Runs = type2Runs = 0;
+  counted = 0;
+}
+
+double RunStats::totalSeconds() const {
+  double t = 0;
+  for(unsigned int s = 0; s < NUM_STAGES; s++) t += seconds[s];
+  return t;
+}
+
+size_t RunStats::totalArrayBytes() const {
+  size_t b = 0;
+  for(unsigned int s = 0; s < NUM_STAGES; s++) b += arrayBytes[s];
+  return b;
+}
+
+void RunStats::add(const RunStats & o){
+  for(unsigned int s = 0; s < NUM_STAGES; s++){
+    seconds[s] += o.seconds[s];
+    arrayBytes[s] += o.arrayBytes[s];
+    processPeakRss[s] = max(processPeakRss[s], o.processPeakRss[s]);
+    candidates[s] += o.candidates[s];
+    for(unsigned int c = 0; c < NUM_COUNTERS; c++) counters[s][c] += o.counters[s][c];
+  }
+  counted |= o.counted;
+  factors += o.factors;
+  type1Runs += o.type1Runs;
+  type2Runs += o.type2Runs;
+}
+
+string RunStats::json() const {
+  char buf[256];
+  string out("{\"stages\": {");
+  for(unsigned int s = 0; s < NUM_STAGES; s++){
+    snprintf(buf, sizeof(buf),
+	     "%s\"%s\": {\"seconds\": %.6f, \"array_bytes\": %lu, \"process_peak_rss\": %lu, \"candidates\": %lu",
+	     s ? ", " : "", stageName(static_cast<enum STAGE>(s)), seconds[s],
+	     (unsigned long) arrayBytes[s], (unsigned long) processPeakRss[s], (unsigned long) candidates[s]);
+    out += buf;
+    for(unsigned int c = 0; c < NUM_COUNTERS; c++){
+      if(!(counted & (1 << c))) continue;
+      snprintf(buf, sizeof(buf), ", \"%s\": %llu",
+	       PerfCounters::name(static_cast<enum COUNTER>(c)), counters[s][c]);
+      out += buf;
+    }
+    if((counted & (1 << COUNTER_CYCLES)) && (counted & (1 << COUNTER_INSTRUCTIONS))){
+      snprintf(buf, sizeof(buf), ", \"ipc\": %.3f", counters[s][COUNTER_CYCLES] ?
+	       (double) counters[s][COUNTER_INSTRUCTIONS] / counters[s][COUNTER_CYCLES] : 0.0);
+      out += buf;
+    }
+    out += "}";
+  }
+  snprintf(buf, sizeof(buf),
+	   "}, \"seconds\": %.6f, \"array_bytes\": %lu, \"factors\": %lu, "
+	   "\"type1_runs\": %lu, \"type2_runs\": %lu, \"runs\": %lu}",
+	   totalSeconds(), (unsigned long) totalArrayBytes(), (unsigned long) factors,
+	   (unsigned long) type1Runs, (unsigned long) type2Runs,
+	   (unsigned long) (type1Runs + type2Runs));
+  return out + buf;
+}
+
+size_t RunStats::currentPeakRss(){
+  struct rusage ru;
+  if(getrusage(RUSAGE_SELF, &ru) != 0) return 0;
+#ifdef __APPLE__
+  return (size_t) ru.ru_maxrss;          // bytes on mac os x
+#else
+  return (size_t) ru.ru_maxrss * 1024;   // kilobytes elsewhere
+#endif
+}
+
+const char * RunStats::stageName(enum STAGE s){
+  switch(s){
+  case STAGE_SUFFIX_SORT: return "suffix_sort";
+  case STAGE_RANK_LCP:    return "rank_lcp";
+  case STAGE_LPF:         return "lpf";
+  case STAGE_TYPE1:       return "type1";
+  case STAGE_TYPE2:       return "type2";
+  default:                return "unknown";
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+StageTimer::StageTimer(RunStats * stats_, enum STAGE stage_)
+  : stats(stats_), stage(stage_), span(RunStats::stageName(stage_))
+{
+  if(stats) gettimeofday(&btv, NULL);
+  if(stats && stats->perf) stats->perf->read(cbegin);
+}
+
+void StageTimer::stop(){
+  span.end();
+  if(stats == NULL) return;
+  if(stats->perf){
+    unsigned long long cend[NUM_COUNTERS];
+    stats->perf->read(cend);
+    for(unsigned int c = 0; c < NUM_COUNTERS; c++) stats->counters[stage][c] += cend[c] - cbegin[c];
+    stats->counted |= stats->perf->availableMask();
+  }
+  struct timeval etv;
+  gettimeofday(&etv, NULL);
+  stats->seconds[stage] += timediff(btv, etv);
+  stats->processPeakRss[stage] = max(stats->processPeakRss[stage], RunStats::currentPeakRss());
+  stats = NULL;
+}
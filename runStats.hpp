@@ -0,0 +1,95 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// runStats.hpp
+// per stage statistics of run finding
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2011 Hideo Bannai
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __RUN_STATS_HPP__
+#define __RUN_STATS_HPP__
+
+#include <sys/time.h>
+#include <cstddef>
+#include <string>
+#include "trace.hpp"
+#include "perfCounters.hpp"
+
+// stages of run finding, in the order they are executed
+enum STAGE {
+  STAGE_SUFFIX_SORT,   // suffix array construction (divsufsort)
+  STAGE_RANK_LCP,      // rank and lcp arrays (calcRankLcp)
+  STAGE_LPF,           // longest previous factors or lz factors
+  STAGE_TYPE1,         // runs crossing lz factor boundaries
+  STAGE_TYPE2,         // runs copied inside lz factors
+  NUM_STAGES
+};
+
+// statistics collected by the engine when a non-NULL RunStats is passed.
+// values accumulate over calls until clear().
+class RunStats {
+public:
+  double seconds[NUM_STAGES];    // wall clock time of each stage
+  size_t arrayBytes[NUM_STAGES]; // capacity of the main arrays of each stage, as
+                                 // the engines report it (not measured: count
+                                 // allocations with a CountingResource for that)
+  size_t processPeakRss[NUM_STAGES]; // peak resident memory of the whole process at
+                                 // the end of each stage (getrusage). it never goes
+                                 // down and includes all threads and earlier calls,
+                                 // so it is not the memory of this call
+  size_t candidates[NUM_STAGES]; // work of the run scans: symbols compared by type1,
+                                 // candidate runs checked by type2
+  size_t factors;                // number of lz factors
+  size_t type1Runs;              // runs found crossing factor boundaries
+  size_t type2Runs;              // runs copied from earlier occurrences
+  unsigned long long counters[NUM_STAGES][NUM_COUNTERS];  // hardware counters of each stage
+  unsigned int counted;          // bit c is set if counter c was measured
+  PerfCounters * perf;           // counters read around each stage (NULL: none).
+                                 // they must belong to the thread doing the work.
+  RunStats();
+  void clear();
+  double totalSeconds() const;
+  size_t totalArrayBytes() const;
+  // add the values of o (processPeakRss is the maximum of both)
+  void add(const RunStats & o);
+  // the statistics as a single line JSON object, with the keys
+  // array_bytes and process_peak_rss for the fields above.
+  // the hardware counters are included if they were measured.
+  std::string json() const;
+  static const char * stageName(enum STAGE s);
+  // peak resident memory of this process in bytes
+  static size_t currentPeakRss();
+};
+
+// measures the wall clock time and process peak resident memory of a stage from
+// construction until stop() or destruction, and the hardware counters if
+// stats->perf is set. does nothing if stats is NULL.
+// the stage is also traced (see trace.hpp).
+class StageTimer {
+  RunStats * stats;
+  enum STAGE stage;
+  struct timeval btv;
+  unsigned long long cbegin[NUM_COUNTERS];
+  TraceSpan span;
+public:
+  StageTimer(RunStats * stats_, enum STAGE stage_);
+  ~StageTimer(){ stop(); }
+  void stop();
+};
+
+#endif//__RUN_STATS_HPP__
@@ -0,0 +1,136 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// saIs.cpp
+// suffix sorting of integer alphabets by induced sorting (SA-IS)
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2011 Hideo Bannai
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "saIs.hpp"
+#include "memoryResource.hpp"
+#include <cassert>
+
+using namespace std;
+
+typedef ResourceVector<unsigned char>::type Types;
+typedef ResourceVector<int>::type Buckets;
+
+// position i is the leftmost of an S-type run (i > 0)
+static inline bool isLms(const Types & t, int i){
+  return i > 0 && t[i] && !t[i-1];
+}
+
+// beginning (or end) of the bucket of each symbol
+template <class T>
+static void buckets(const T * s, int n, Buckets & bkt, bool end){
+  int c, sum = 0;
+  for(c = 0; c < (int) bkt.size(); c++) bkt[c] = 0;
+  for(int i = 0; i < n; i++) bkt[s[i]]++;
+  for(c = 0; c < (int) bkt.size(); c++){
+    sum += bkt[c];
+    bkt[c] = end ? sum : sum - bkt[c];
+  }
+}
+
+// sort the L-type suffixes from the sorted LMS suffixes in sa, then the
+// S-type ones from the L-type ones. the suffix n-1 is L-type, and is the
+// first (after the end of the text).
+template <class T>
+static void induce(const T * s, int * sa, int n, const Types & t, Buckets & bkt){
+  int i, j;
+  buckets(s, n, bkt, false);
+  sa[bkt[s[n-1]]++] = n - 1;
+  for(i = 0; i < n; i++){
+    j = sa[i] - 1;
+    if(j >= 0 && !t[j]) sa[bkt[s[j]]++] = j;
+  }
+  buckets(s, n, bkt, true);
+  for(i = n; i-- > 0;){
+    j = sa[i] - 1;
+    if(j >= 0 && t[j]) sa[--bkt[s[j]]] = j;
+  }
+}
+
+template <class T>
+void saIs(const T * s, int * sa, unsigned int n_, unsigned int sigma){
+  int i, j, n = n_, n1, name, prev, d;
+  if(n <= 1){
+    if(n == 1) sa[0] = 0;
+    return;
+  }
+  Types t(n);                            // 1: S-type, 0: L-type
+  Buckets bkt(sigma);
+  t[n-1] = 0;
+  for(i = n - 1; i-- > 0;){
+    t[i] = (s[i] < s[i+1] || (s[i] == s[i+1] && t[i+1])) ? 1 : 0;
+  }
+
+  // sort the LMS substrings
+  buckets(s, n, bkt, true);
+  for(i = 0; i < n; i++) sa[i] = -1;
+  for(i = 1; i < n; i++) if(isLms(t, i)) sa[--bkt[s[i]]] = i;
+  induce(s, sa, n, t, bkt);
+
+  // name them: the sorted ones go to sa[0..n1), their names to
+  // sa[n1 + pos / 2] (lms positions are at least 2 apart)
+  for(i = n1 = 0; i < n; i++) if(isLms(t, sa[i])) sa[n1++] = sa[i];
+  for(i = n1; i < n; i++) sa[i] = -1;
+  for(i = name = 0, prev = -1; i < n1; i++){
+    int pos = sa[i];
+    bool diff = false;
+    for(d = 0; ; d++){
+      if(prev < 0 || pos + d == n || prev + d == n
+	 || s[pos+d] != s[prev+d] || t[pos+d] != t[prev+d]){
+	diff = true;
+	break;
+      }
+      if(d > 0 && isLms(t, pos + d)) break;
+    }
+    if(diff){
+      name++;
+      prev = pos;
+    }
+    sa[n1 + pos / 2] = name - 1;
+  }
+  for(i = j = n - 1; i >= n1; i--) if(sa[i] >= 0) sa[j--] = sa[i];
+
+  // sort the reduced string s1 = sa[n-n1..n) into sa[0..n1)
+  int * s1 = sa + n - n1;
+  if(name < n1){
+    saIs(s1, sa, n1, name);
+  } else {
+    for(i = 0; i < n1; i++) sa[s1[i]] = i;
+  }
+
+  // sort all suffixes from the sorted LMS suffixes
+  for(i = 1, j = 0; i < n; i++) if(isLms(t, i)) s1[j++] = i;
+  for(i = 0; i < n1; i++) sa[i] = s1[sa[i]];
+  for(i = n1; i < n; i++) sa[i] = -1;
+  buckets(s, n, bkt, true);
+  for(i = n1; i-- > 0;){
+    j = sa[i];
+    sa[i] = -1;
+    sa[--bkt[s[j]]] = j;
+  }
+  induce(s, sa, n, t, bkt);
+}
+
+template void saIs(const unsigned char * s, int * sa, unsigned int n, unsigned int sigma);
+template void saIs(const unsigned short * s, int * sa, unsigned int n, unsigned int sigma);
+template void saIs(const unsigned int * s, int * sa, unsigned int n, unsigned int sigma);
+template void saIs(const int * s, int * sa, unsigned int n, unsigned int sigma);
@@ -0,0 +1,37 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// saIs.hpp
+// suffix sorting of integer alphabets by induced sorting (SA-IS)
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2011 Hideo Bannai
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __SA_IS_HPP__
+#define __SA_IS_HPP__
+
+// suffix array sa[0..n-1] of s[0..n-1], whose symbols are in [0, sigma).
+// linear time, with n bytes of types and sigma ints of buckets besides sa
+// (which also holds the reduced problem). the end of s is smaller than
+// any symbol. T is unsigned char, unsigned short, unsigned int or int.
+// see: G. Nong, S. Zhang and W. H. Chan, Two Efficient Algorithms for
+// Linear Time Suffix Array Construction. IEEE Trans. Computers 60(10):
+// 1471-1484 (2011)
+template <class T>
+void saIs(const T * s, int * sa, unsigned int n, unsigned int sigma);
+
+#endif//__SA_IS_HPP__
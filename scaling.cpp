@@ -0,0 +1,40 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// scaling.cpp
+// empirical scaling of measurements with input size
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2011 Hideo Bannai
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "scaling.hpp"
+#include <cmath>
+
+using namespace std;
+
+double scalingExponent(const vector<double> & n, const vector<double> & y){
+  double sx = 0, sy = 0, sxx = 0, sxy = 0;
+  unsigned int k = 0;
+  for(unsigned int i = 0; i < n.size() && i < y.size(); i++){
+    if(n[i] <= 0 || y[i] <= 0) continue;
+    double lx = log(n[i]), ly = log(y[i]);
+    sx += lx; sy += ly; sxx += lx * lx; sxy += lx * ly;
+    k++;
+  }
+  if(k < 2 || k * sxx == sx * sx) return 0;
+  return (k * sxy - sx * sy) / (k * sxx - sx * sx);
+}
@@ -0,0 +1,34 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// scaling.hpp
+// empirical scaling of measurements with input size
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2011 Hideo Bannai
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __SCALING_HPP__
+#define __SCALING_HPP__
+
+#include <vector>
+
+// exponent e of the best fit y ~ c * n^e, i.e. the least squares slope
+// of log y against log n. pairs with a non-positive value are ignored.
+// returns 0 if fewer than two pairs remain.
+double scalingExponent(const std::vector<double> & n, const std::vector<double> & y);
+
+#endif//__SCALING_HPP__
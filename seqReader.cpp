@@ -0,0 +1,241 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// seqReader.cpp
+// zero-copy input of sequence files (raw, FASTA, FASTQ)
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2011 Hideo Bannai
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "seqReader.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <sstream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////////////
+
+SeqRecord::SeqRecord()
+  : name(NULL), name_len(0), seq(NULL), len(0)
+{};
+
+////////////////////////////////////////////////////////////////////////////////
+
+MappedFile::MappedFile()
+  : data(NULL), length(0), mapped(false)
+{};
+
+MappedFile::~MappedFile(){
+  close();
+}
+
+bool MappedFile::open(const char * path){
+  int fd;
+  struct stat st;
+  close();
+  fd = (strcmp(path, "-") == 0) ? 0 : ::open(path, O_RDONLY);
+  if(fd < 0) return false;
+  if(fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0){
+    void * p = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    if(p != MAP_FAILED){
+      madvise(p, st.st_size, MADV_SEQUENTIAL);
+      data = static_cast<char *>(p);
+      length = st.st_size;
+      mapped = true;
+      if(fd != 0) ::close(fd);
+      return true;
+    }
+  }
+  // not mappable (pipe, terminal, ...): slurp it
+  size_t cap = 1 << 20;
+  ssize_t r;
+  data = static_cast<char *>(malloc(cap));
+  while(data != NULL && (r = read(fd, data + length, cap - length)) != 0){
+    if(r < 0){
+      if(errno == EINTR) continue;
+      break;
+    }
+    length += r;
+    if(length == cap){
+      char * np = static_cast<char *>(realloc(data, cap *= 2));
+      if(np == NULL) break;
+      data = np;
+    }
+  }
+  int saved = errno;
+  bool ok = (data != NULL && r == 0);
+  if(fd != 0) ::close(fd);
+  if(!ok){ close(); errno = saved; }
+  return ok;
+}
+
+void MappedFile::close(){
+  if(mapped){
+    munmap(data, length);
+  } else {
+    free(data);
+  }
+  data = NULL;
+  length = 0;
+  mapped = false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static inline bool isBlank(char c){
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+}
+
+// end of line starting at p (position of '\n' or e)
+static inline char * lineEnd(char * p, char * e){
+  char * q = static_cast<char *>(memchr(p, '\n', e - p));
+  return q ? q : e;
+}
+
+// move the contents of lines [p, e) to w, dropping line breaks and
+// trailing blanks. returns the new end of the sequence.
+static char * squeeze(char * w, char * p, char * e){
+  while(p < e){
+    char * le = lineEnd(p, e);
+    char * te = le;
+    while(te > p && isBlank(te[-1])) te--;
+    if(w != p) memmove(w, p, te - p);
+    w += te - p;
+    p = (le < e) ? le + 1 : e;
+  }
+  return w;
+}
+
+// name of a record is the first word of its header line [p, e)
+static void setName(SeqRecord & rec, char * p, char * e){
+  char * q = p;
+  while(q < e && !isBlank(*q)) q++;
+  rec.name = p;
+  rec.name_len = q - p;
+}
+
+const size_t SeqParser::MAX_LEN;
+
+SeqParser::SeqParser(enum SEQFORMAT fmt_)
+  : fmt(fmt_), maxLen(MAX_LEN)
+{};
+
+enum SEQFORMAT SeqParser::detect(const char * buf, size_t len){
+  size_t i;
+  for(i = 0; i < len && isBlank(buf[i]); i++){};
+  if(i == len) return SEQ_AUTO;
+  if(buf[i] == '>') return SEQ_FASTA;
+  if(buf[i] == '@') return SEQ_FASTQ;
+  return SEQ_RAW;
+}
+
+size_t SeqParser::parse(char * buf, size_t len, bool last, vector<SeqRecord> & recs){
+  char * p = buf, * e = buf + len;
+  if(fmt == SEQ_AUTO) fmt = detect(buf, len);
+  while(err.empty()){
+    while(p < e && isBlank(*p)) p++;
+    if(p == e) return len;
+    char * rb = p;                       // beginning of record
+    SeqRecord rec;
+    switch(fmt){
+    case SEQ_RAW: {
+      while(p < e && !isBlank(*p)) p++;
+      if(p == e && !last) return rb - buf;
+      rec.seq = rb;
+      rec.len = p - rb;
+      break;
+    }
+    case SEQ_FASTA: {
+      if(*p != '>'){ err = "FASTA record does not start with '>'"; return rb - buf; }
+      char * he = lineEnd(p, e);
+      if(he == e && !last) return rb - buf;
+      setName(rec, p + 1, he);
+      // the record ends at the next line starting with '>'
+      char * re = he;
+      while(re < e){
+	if(re + 1 == e){ re = e; break; } // trailing line break
+	if(re[1] == '>') break;
+	re = lineEnd(re + 1, e);
+      }
+      if(re == e && !last) return rb - buf;
+      char * sb = (he < e) ? he + 1 : e;
+      rec.seq = sb;
+      rec.len = squeeze(sb, sb, re) - sb;
+      p = re;
+      break;
+    }
+    case SEQ_FASTQ: {
+      if(*p != '@'){ err = "FASTQ record does not start with '@'"; return rb - buf; }
+      char * he = lineEnd(p, e);
+      if(he == e){
+	if(!last) return rb - buf;
+	err = "truncated FASTQ record"; return rb - buf;
+      }
+      setName(rec, p + 1, he);
+      // sequence lines up to the '+' separator
+      char * sb = he + 1, * q = sb;
+      size_t slen = 0;
+      while(q < e && *q != '+'){
+	char * le = lineEnd(q, e), * te = le;
+	while(te > q && isBlank(te[-1])) te--;
+	slen += te - q;
+	q = (le < e) ? le + 1 : e;
+      }
+      if(q == e){
+	if(!last) return rb - buf;
+	err = "truncated FASTQ record"; return rb - buf;
+      }
+      // quality lines until as many symbols as the sequence are read
+      char * se = q;
+      q = lineEnd(q, e);
+      size_t qlen = 0;
+      while(q < e && qlen < slen){
+	q++;
+	char * le = lineEnd(q, e), * te = le;
+	while(te > q && isBlank(te[-1])) te--;
+	qlen += te - q;
+	q = le;
+      }
+      if(qlen < slen || (q == e && !last)){
+	if(!last) return rb - buf;
+	err = "truncated FASTQ record"; return rb - buf;
+      }
+      rec.seq = sb;
+      rec.len = squeeze(sb, sb, se) - sb;
+      p = q;
+      break;
+    }
+    default:
+      return len;                        // only blanks so far
+    }
+    if(rec.len > maxLen){
+      ostringstream os;
+      os << "record " << rec.getName() << (rec.name_len ? " " : "")
+	 << "has " << rec.len << " symbols, more than " << maxLen;
+      err = os.str();
+      return rb - buf;
+    }
+    recs.push_back(rec);
+  }
+  return p - buf;
+}
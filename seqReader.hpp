@@ -0,0 +1,95 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// seqReader.hpp
+// zero-copy input of sequence files (raw, FASTA, FASTQ)
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2011 Hideo Bannai
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __SEQ_READER_HPP__
+#define __SEQ_READER_HPP__
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+enum SEQFORMAT {
+  SEQ_AUTO,    // guess from the first non-blank character
+  SEQ_RAW,     // whitespace separated strings (same as cin >> s)
+  SEQ_FASTA,   // '>' header lines followed by (multi-line) sequences
+  SEQ_FASTQ,   // '@' header, sequence, '+' line, quality
+};
+
+// a record of an input buffer.
+// name and seq point into the buffer the record was parsed from,
+// and are valid as long as that buffer is.
+class SeqRecord {
+public:
+  const char * name;    // record name (first word of header), not terminated
+  size_t name_len;      // 0 for raw input
+  const char * seq;     // sequence with line breaks removed
+  size_t len;
+  SeqRecord();
+  std::string getName() const { return std::string(name, name_len); }
+};
+
+// a writable view of a whole input file.
+// regular files are mapped privately, so pages are only copied
+// when a multi-line record is compacted; pipes are read into memory.
+class MappedFile {
+  char * data;
+  size_t length;
+  bool mapped;
+  MappedFile(const MappedFile &);
+  MappedFile & operator=(const MappedFile &);
+public:
+  MappedFile();
+  ~MappedFile();
+  // open path ("-" for stdin). returns false and sets errno on failure.
+  bool open(const char * path);
+  void close();
+  char * begin() const { return data; }
+  size_t size() const { return length; }
+};
+
+// parser of sequence records.
+// records are parsed in place: line breaks inside a sequence are squeezed
+// out by moving the sequence over them, so the buffer must be writable.
+class SeqParser {
+  enum SEQFORMAT fmt;
+  size_t maxLen;
+  std::string err;
+public:
+  // longest record by default: the engines take lengths of unsigned int
+  static const size_t MAX_LEN = 0xffffffffu;
+  SeqParser(enum SEQFORMAT fmt_ = SEQ_AUTO);
+  // longer records are an error, not truncated
+  void setMaxLength(size_t m){ maxLen = m; }
+  // guess the format of a buffer from its first non-blank character.
+  static enum SEQFORMAT detect(const char * buf, size_t len);
+  // parse records in buf[0..len) and append them to recs.
+  // if last is false, a trailing record that may continue beyond len
+  // is not parsed. returns the number of bytes consumed, i.e. the offset
+  // where parsing should resume once more data is available.
+  // on malformed input, parsing stops and error() becomes non-empty.
+  size_t parse(char * buf, size_t len, bool last, std::vector<SeqRecord> & recs);
+  enum SEQFORMAT format() const { return fmt; }
+  const std::string & error() const { return err; }
+};
+
+#endif//__SEQ_READER_HPP__
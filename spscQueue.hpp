@@ -0,0 +1,96 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// spscQueue.hpp
+// bounded lock-free single producer / single consumer queue of pointers
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2011 Hideo Bannai
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __SPSC_QUEUE_HPP__
+#define __SPSC_QUEUE_HPP__
+
+#include <cstddef>
+#include <sched.h>
+#include <time.h>
+#include "trace.hpp"
+
+// ring buffer of pointers shared by exactly one producer thread and one
+// consumer thread. the producer only writes tail, and the consumer only
+// writes head, so no locks are needed; the indices are published with
+// release stores and read with acquire loads (gcc atomic builtins).
+// blocking push/pop spin with sched_yield, then back off with short sleeps.
+// the time they wait is traced.
+template <class T>
+class SPSCQueue {
+  T ** ring;
+  size_t mask;
+  char pad0[64];
+  size_t head;                  // next slot to pop (written by consumer)
+  char pad1[64];
+  size_t tail;                  // next slot to push (written by producer)
+  char pad2[64];
+  SPSCQueue(const SPSCQueue &);
+  SPSCQueue & operator=(const SPSCQueue &);
+  static void backoff(unsigned int & spins){
+    if(++spins < 64){
+      sched_yield();
+    } else {
+      struct timespec ts = { 0, 20000 };
+      nanosleep(&ts, NULL);
+    }
+  }
+public:
+  // capacity is rounded up to a power of two
+  SPSCQueue(size_t capacity) : head(0), tail(0) {
+    size_t c = 2;
+    while(c < capacity) c <<= 1;
+    ring = new T * [c];
+    mask = c - 1;
+  }
+  ~SPSCQueue(){ delete [] ring; }
+  bool tryPush(T * p){
+    size_t t = tail;
+    if(t - __atomic_load_n(&head, __ATOMIC_ACQUIRE) > mask) return false;  // full
+    ring[t & mask] = p;
+    __atomic_store_n(&tail, t + 1, __ATOMIC_RELEASE);
+    return true;
+  }
+  bool tryPop(T * & p){
+    size_t h = head;
+    if(h == __atomic_load_n(&tail, __ATOMIC_ACQUIRE)) return false;         // empty
+    p = ring[h & mask];
+    __atomic_store_n(&head, h + 1, __ATOMIC_RELEASE);
+    return true;
+  }
+  void push(T * p){
+    if(tryPush(p)) return;
+    TraceSpan span("queue full");
+    unsigned int spins = 0;
+    while(!tryPush(p)) backoff(spins);
+  }
+  T * pop(){
+    T * p;
+    if(tryPop(p)) return p;
+    TraceSpan span("queue empty");
+    unsigned int spins = 0;
+    while(!tryPop(p)) backoff(spins);
+    return p;
+  }
+};
+
+#endif//__SPSC_QUEUE_HPP__
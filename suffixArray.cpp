@@ -22,34 +22,64 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "suffixArray.hpp"
+#include "largeArray.hpp"
+#include "saIs.hpp"
+#include <cassert>
+#include <algorithm>
+#include <deque>
 
 // use divsufsort library by Yuta Mori
 #include "divsufsort.h"
 
 using namespace std;
 
-SuffixArrayAux::SuffixArrayAux(const string & s) 
-  : t(s), ranka(s.size()), lcpa(s.size())
+template <>
+BasicSuffixArray<unsigned char>::BasicSuffixArray(const string & s, RunStats * stats,
+						  const RunOptions & opts)
+  : t(reinterpret_cast<const unsigned char *>(s.data())), n(s.size())
 {
-  SA = new int[s.size()];
-  divsufsort(reinterpret_cast<const unsigned char *>(s.c_str()), SA, s.size());
+  this->construct(stats, opts);
+}
+
+template <class T>
+BasicSuffixArray<T>::BasicSuffixArray(const T * s, uInt n_, RunStats * stats,
+				      const RunOptions & opts)
+  : t(s), n(n_)
+{
+  this->construct(stats, opts);
+}
+
+template <class T>
+void BasicSuffixArray<T>::construct(RunStats * stats, const RunOptions & opts){
+  StageTimer sorting(stats, STAGE_SUFFIX_SORT);
+  LargeArray::assign(sa, n, opts.alloc);
+  if(n > 0) sort(t, reinterpret_cast<int *>(&sa[0]), n, opts);
+  sorting.stop();
+  StageTimer ranklcp(stats, STAGE_RANK_LCP);
+  LargeArray::assign(ranka, n, opts.alloc);
+  LargeArray::assign(lcpa, n, opts.alloc);
   this->calcRankLcp();
+  if(stats){
+    stats->arrayBytes[STAGE_SUFFIX_SORT] += sa.capacity() * sizeof(uInt);
+    stats->arrayBytes[STAGE_RANK_LCP] += (ranka.capacity() + lcpa.capacity()) * sizeof(uInt);
+  }
 }
 
-void SuffixArrayAux::calcRankLcp(){
+template <class T>
+void BasicSuffixArray<T>::calcRankLcp(){
   uInt i, j, h, x;
-  const char * text = t.c_str();
-  const char * ep = t.c_str() + t.size();
+  const T * text = t;
+  const T * ep = t + n;
 
   // compute rank array
-  for(i = 0; i < t.size(); i++) ranka[SA[i]] = i;
+  for(i = 0; i < n; i++) ranka[sa[i]] = i;
 
   // compute lcp array
-  for(h = i = 0; i < t.size(); i++){
+  for(h = i = 0; i < n; i++){
     x = ranka[i];
     if(x > 0){
-      const char * p0, * p1;
-      j = SA[x-1];
+      const T * p0, * p1;
+      j = sa[x-1];
       p1 = text + i + h;
       p0 = text + j + h;
       while((p0 != ep) && (p1 != ep) && (*p1 == *p0)){
@@ -62,6 +92,172 @@ void SuffixArrayAux::calcRankLcp(){
   return;
 }
 
-SuffixArrayAux::~SuffixArrayAux(){
-  delete [] SA;
+// compares suffixes i and j by their ranks at offset h (-1 past the end)
+class RankAt {
+  const int * rank;
+  int n, h;
+public:
+  RankAt(const int * rank_, int n_, int h_) : rank(rank_), n(n_), h(h_) {}
+  int operator()(int i) const { return (i + h < n) ? rank[i + h] : -1; }
+  bool operator()(int i, int j) const { return (*this)(i) < (*this)(j); }
+};
+
+// suffix sorting of short texts by prefix doubling, in stack space. the
+// suffixes are bucketed by their first character over the dense alphabet
+// of t, then each group of suffixes with the same rank (the index of its
+// first suffix) is sorted by the rank h characters later, for h = 1, 2,
+// 4, ... until all ranks differ. divsufsort spends more time clearing its
+// 256 + 256 * 256 buckets than this on short reads.
+static void smallSort(const unsigned char * t, int * sa, uInt n){
+  int rank[SuffixArrayAux::SMALL_LIMIT], tmp[SuffixArrayAux::SMALL_LIMIT];
+  int code[256], count[257];
+  uInt c, i, j, k, sigma = 0;
+  assert(n <= SuffixArrayAux::SMALL_LIMIT);
+  for(c = 0; c < 256; c++) code[c] = -1;
+  for(i = 0; i < n; i++) code[t[i]] = 0;
+  for(c = 0; c < 256; c++) if(code[c] == 0) code[c] = sigma++;
+  for(c = 0; c <= sigma; c++) count[c] = 0;
+  for(i = 0; i < n; i++) count[code[t[i]] + 1]++;
+  for(c = 0; c < sigma; c++) count[c + 1] += count[c];
+  for(i = 0; i < n; i++) rank[i] = count[code[t[i]]];
+  for(i = 0; i < n; i++) sa[count[code[t[i]]]++] = i;
+  for(uInt h = 1; h < n; h *= 2){
+    RankAt key(rank, n, h);
+    bool done = true;
+    for(j = 0; j < n; j = k){
+      for(k = j + 1; k < n && rank[sa[k]] == (int) j; k++);
+      if(k - j > 1){
+	std::sort(sa + j, sa + k, key);
+	done = false;
+      }
+    }
+    if(done) break;
+    // new rank: the index of the first suffix with the same pair of ranks
+    for(j = 0; j < n; j++){
+      tmp[sa[j]] = (j > 0 && rank[sa[j]] == rank[sa[j-1]] && key(sa[j]) == key(sa[j-1]))
+	? tmp[sa[j-1]] : (int) j;
+    }
+    for(i = 0; i < n; i++) rank[i] = tmp[i];
+  }
+}
+
+static void sortDivsufsort(const unsigned char * t, int * sa, uInt n){
+  if(n <= 2){
+    divsufsort_ws(t, sa, n, NULL);
+    return;
+  }
+  ResourceVector<int>::type work(DIVSUFSORT_WORK_SIZE);
+  int r = divsufsort_ws(t, sa, n, &work[0]);
+  assert(r == 0);
+  (void) r;
+}
+
+static void sortSaIs(const unsigned char * t, int * sa, uInt n){
+  saIs(t, sa, n, 256);
 }
+
+// byte texts up to this length are sorted by SA-IS under auto
+static const uInt SAIS_MAX = 8192;
+
+// doubling up to smallMax, SA-IS up to saisMax, divsufsort above (by
+// length only, see SuffixSorter). divsufsort clears and fills 256 + 256 *
+// 256 buckets whatever the length of the text, which takes longer than
+// SA-IS on texts of a few thousand symbols. above, divsufsort is faster
+// on all but highly repetitive texts.
+static void sortAuto(const unsigned char * t, int * sa, uInt n, uInt smallMax,
+		     uInt saisMax = SAIS_MAX){
+  if(n > 2 && n <= smallMax){
+    smallSort(t, sa, n);
+  } else if(n > 2 && n <= saisMax){
+    sortSaIs(t, sa, n);
+  } else {
+    sortDivsufsort(t, sa, n);
+  }
+}
+
+// a deque, so that the backends in RunOptions stay put when more are added
+static deque<SuffixSorter> & sorters(){
+  static deque<SuffixSorter> r;
+  if(r.empty()){
+    SuffixSorter b[] = {
+      { "auto", "doubling, sais or divsufsort by length", NULL, 0 },
+      { "divsufsort", "divsufsort by Yuta Mori", sortDivsufsort, 0 },
+      { "sais", "SA-IS, linear time", sortSaIs, 0 },
+      { "doubling", "prefix doubling in stack space", smallSort, SuffixArrayAux::SMALL_LIMIT }
+    };
+    r.assign(b, b + sizeof(b) / sizeof(b[0]));
+  }
+  return r;
+}
+
+bool SuffixSorter::add(const char * name, const char * description, Function sort,
+		       uInt maxLength){
+  if(find(name) != NULL || sort == NULL) return false;
+  SuffixSorter s = { name, description, sort, maxLength };
+  sorters().push_back(s);
+  return true;
+}
+
+unsigned int SuffixSorter::count(){
+  return sorters().size();
+}
+
+const SuffixSorter & SuffixSorter::get(unsigned int i){
+  return sorters()[i];
+}
+
+const SuffixSorter * SuffixSorter::find(const char * name){
+  for(unsigned int i = 0; i < count(); i++){
+    if(string(name) == get(i).name) return &get(i);
+  }
+  return NULL;
+}
+
+const char * SuffixSorter::nameOf(const SuffixSorter * sorter){
+  return sorter ? sorter->name : "default";
+}
+
+template <>
+void BasicSuffixArray<unsigned char>::sort(const unsigned char * t, int * sa, uInt n,
+					   const RunOptions & opts){
+  const SuffixSorter * s = opts.sorter;
+  uInt smallMax = min(opts.smallSort, (uInt) SMALL_LIMIT);
+  if(s == NULL){
+    sortAuto(t, sa, n, smallMax, 0);    // the default: auto without SA-IS
+  } else if(s->sort != NULL && (s->maxLength == 0 || n <= s->maxLength)){
+    s->sort(t, sa, n);
+  } else {
+    sortAuto(t, sa, n, smallMax);
+  }
+}
+
+template <class T>
+void BasicSuffixArray<T>::sort(const T * t, int * sa, uInt n, const RunOptions &){
+  uInt i, top = 0;
+  for(i = 0; i < n; i++) top = max(top, (uInt) t[i]);
+  if(top < 2 * (size_t) n + 256){
+    saIs(t, sa, n, top + 1);
+    return;
+  }
+  // a sparse alphabet: sort over the ranks of the symbols
+  typename ResourceVector<T>::type sym(t, t + n);
+  UIntArray rank(n);
+  std::sort(sym.begin(), sym.end());
+  sym.erase(unique(sym.begin(), sym.end()), sym.end());
+  for(i = 0; i < n; i++) rank[i] = lower_bound(sym.begin(), sym.end(), t[i]) - sym.begin();
+  uInt sigma = sym.size();
+  freeVector(sym);
+  saIs(&rank[0], sa, n, sigma);
+}
+
+template <class T>
+void BasicSuffixArray<T>::release(UIntArray & sa_, UIntArray & rank_, UIntArray & lcp_){
+  moveVector(sa, sa_);
+  moveVector(ranka, rank_);
+  moveVector(lcpa, lcp_);
+  n = 0;
+}
+
+template class BasicSuffixArray<unsigned char>;
+template class BasicSuffixArray<unsigned short>;
+template class BasicSuffixArray<unsigned int>;
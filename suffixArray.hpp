@@ -26,25 +26,101 @@
 
 #include <string>
 #include <vector>
+#include "runStats.hpp"
+#include "memoryResource.hpp"
+#include "runOptions.hpp"
 
 typedef unsigned int uInt;
 
-class SuffixArrayAux {
-  int * SA;
-  const std::string & t;
-  std::vector<uInt> ranka;
-  std::vector<uInt> lcpa;  
+// a registered suffix sorting backend of byte texts. the backend used by
+// SuffixArrayAux is given by RunOptions::sorter, which may be looked up by
+// name at run time. without one (the default), texts up to
+// RunOptions::smallSort are sorted by doubling and longer ones by
+// divsufsort. the built in backends are
+//   auto:       doubling up to RunOptions::smallSort, SA-IS up to 8192,
+//               divsufsort above
+//   divsufsort: divsufsort by Yuta Mori
+//   sais:       SA-IS (see saIs.hpp)
+//   doubling:   prefix doubling in stack space, up to SMALL_LIMIT
+// texts longer than maxLength of the backend are sorted by auto.
+// the default and auto differ on purpose: the default sorts as before
+// the backends were added, so that existing callers keep their results
+// and timings, while auto also takes SA-IS where it was measured faster.
+// both choose by length only, and ignore the alphabet of the text.
+// texts of wider symbols are always sorted by SA-IS, directly or over
+// dense ranks depending on their alphabet (see BasicSuffixArray::sort).
+// backends should be added before any sorting starts, and are not moved.
+class SuffixSorter {
+public:
+  typedef void (*Function)(const unsigned char * t, int * sa, uInt n);
+  const char * name;
+  const char * description;
+  Function sort;           // sa[0..n-1] of t[0..n-1] (NULL for auto)
+  uInt maxLength;          // longest text it can sort (0: any)
+  // register a backend. false if the name is already taken.
+  static bool add(const char * name, const char * description, Function sort,
+		  uInt maxLength = 0);
+  static unsigned int count();
+  static const SuffixSorter & get(unsigned int i);
+  // the backend named name (NULL: none)
+  static const SuffixSorter * find(const char * name);
+  // name of sorter, "default" for NULL
+  static const char * nameOf(const SuffixSorter * sorter);
+};
+
+// suffix, rank and lcp arrays of a text of symbols of type T: unsigned
+// char (SuffixArrayAux), unsigned short or unsigned int.
+template <class T>
+class BasicSuffixArray {
+  UIntArray sa;
+  const T * t;
+  uInt n;
+  UIntArray ranka;
+  UIntArray lcpa;  
+  void construct(RunStats * stats, const RunOptions & opts);
   void calcRankLcp();
+  BasicSuffixArray(const BasicSuffixArray &);
+  BasicSuffixArray & operator=(const BasicSuffixArray &);
 public:
-  SuffixArrayAux();
-  // construct rank, lcp, suffix arrays for string s
-  SuffixArrayAux(const std::string & s);
-  ~SuffixArrayAux();
-  uInt size() const { return t.size(); }
-  const int * getSA() const { return SA; }
-  const std::vector<uInt> & getLCP() const { return lcpa; }
-  const std::vector<uInt> & getRANK() const { return ranka; }
-  const std::string & text() const { return t; };
+  // construct rank, lcp, suffix arrays for string s (bytes only).
+  // if stats is not NULL, the time of each stage is added to it.
+  // the text is sorted and the arrays placed as opts says.
+  BasicSuffixArray(const std::string & s, RunStats * stats = NULL,
+		   const RunOptions & opts = RunOptions());
+  // construct rank, lcp, suffix arrays for s[0..n-1].
+  // the text is not copied, and must outlive this object.
+  BasicSuffixArray(const T * s, uInt n, RunStats * stats = NULL,
+		   const RunOptions & opts = RunOptions());
+  uInt size() const { return n; }
+  const int * getSA() const { return sa.empty() ? NULL : reinterpret_cast<const int *>(&sa[0]); }
+  // the lcp and rank arrays are UIntArrays (they were std::vector<uInt>
+  // before the arrays were taken from a MemoryResource): copy them to
+  // keep a std::vector.
+  const UIntArray & getLCP() const { return lcpa; }
+  const UIntArray & getRANK() const { return ranka; }
+  const T * text() const { return t; };
+  // move the arrays out (without copying them if the arguments have the
+  // same memory resource), so that they can be overwritten or freed as
+  // soon as they are not needed.
+  // this object is empty afterwards.
+  void release(UIntArray & sa_, UIntArray & rank_, UIntArray & lcp_);
+  // the same with std::vector: the arrays are copied
+  void release(std::vector<uInt> & sa_, std::vector<uInt> & rank_, std::vector<uInt> & lcp_){
+    UIntArray s, r, l;
+    release(s, r, l);
+    sa_.assign(s.begin(), s.end());
+    rank_.assign(r.begin(), r.end());
+    lcp_.assign(l.begin(), l.end());
+  }
+  // suffix array sa[0..n-1] of t[0..n-1]. byte texts are sorted by
+  // opts.sorter (see SuffixSorter). wider symbols are sorted by SA-IS,
+  // over their dense ranks if the largest is beyond 2n + 256.
+  static void sort(const T * t, int * sa, uInt n,
+		   const RunOptions & opts = RunOptions());
+  // longest text sorted by doubling (see RunOptions::smallSort)
+  enum { SMALL_LIMIT = 2048 };
 };
 
+typedef BasicSuffixArray<unsigned char> SuffixArrayAux;
+
 #endif//__SUFFIX_ARRAY_HPP__
@@ -0,0 +1,172 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// corpusTest.cpp
+// test routines for the benchmark corpora and stage statistics
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2011 Hideo Bannai
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include "../corpus.hpp"
+#include "../runFinder.hpp"
+
+using namespace std;
+
+TEST(corpus, words){
+  string s;
+  Corpus::generate(CORPUS_FIBONACCI, 13, s);
+  EXPECT_EQ(s, "abaababaabaab");
+  Corpus::generate(CORPUS_THUE_MORSE, 16, s);
+  EXPECT_EQ(s, "abbabaabbaababba");
+  Corpus::generate(CORPUS_UNARY, 5, s);
+  EXPECT_EQ(s, "aaaaa");
+  Corpus::generate(CORPUS_RUN_RICH, 1558, s);
+  EXPECT_EQ(runFinder::countRuns(s), (unsigned int) 1455);
+  Corpus::generate(CORPUS_FIBONACCI, 1, s);
+  EXPECT_EQ(s, "a");
+}
+
+// morphic words against their morphisms
+static string iterate(const char * ma, const char * mb, size_t n){
+  string w("a");
+  while(w.size() < n){
+    string v;
+    for(size_t i = 0; i < w.size(); i++) v += (w[i] == 'a') ? ma : mb;
+    w = v;
+  }
+  return w.substr(0, n);
+}
+
+TEST(corpus, morphic){
+  string s;
+  Corpus::generate(CORPUS_FIBONACCI, 5000, s);
+  EXPECT_EQ(s, iterate("ab", "a", 5000));
+  Corpus::generate(CORPUS_THUE_MORSE, 5000, s);
+  EXPECT_EQ(s, iterate("ab", "ba", 5000));
+  Corpus::generate(CORPUS_PERIOD_DOUBLING, 5000, s);
+  EXPECT_EQ(s, iterate("ab", "aa", 5000));
+  CorpusParams p;
+  p.directive.assign(1, 1);
+  Corpus::generate(CORPUS_STURMIAN, 5000, s, p);
+  EXPECT_EQ(s, iterate("ab", "a", 5000));
+  p.directive.assign(1, 2);
+  Corpus::generate(CORPUS_STURMIAN, 17, s, p);
+  EXPECT_EQ(s, "aabaabaaabaabaaab");
+}
+
+// sturmian words are balanced: windows of equal length differ by at most one b
+TEST(corpus, sturmian){
+  string s;
+  CorpusParams p;
+  p.directive.clear();
+  p.directive.push_back(1);
+  p.directive.push_back(3);
+  p.directive.push_back(2);
+  Corpus::generate(CORPUS_STURMIAN, 2000, s, p);
+  for(size_t len = 1; len < 50; len++){
+    size_t lo = len, hi = 0, b = count(s.begin(), s.begin() + len, 'b');
+    for(size_t i = 0; i + len <= s.size(); i++){
+      if(i > 0) b += (s[i + len - 1] == 'b') - (s[i - 1] == 'b');
+      lo = min(lo, b);
+      hi = max(hi, b);
+    }
+    EXPECT_LE(hi - lo, (size_t) 1) << len;
+  }
+}
+
+// streaming in pieces gives the same string
+TEST(corpus, streaming){
+  CorpusParams p;
+  p.alphabet = "acgt";
+  p.period = 37;
+  p.mutation = 0.05;
+  for(unsigned int c = 0; c < NUM_CORPORA; c++){
+    string s, t(10000, 0);
+    Corpus::generate(static_cast<enum CORPUS>(c), t.size(), s, p);
+    CorpusGenerator gen(static_cast<enum CORPUS>(c), p);
+    for(size_t i = 0, l = 1; i < t.size(); i += l, l = l * 3 % 1001){
+      l = min(l, t.size() - i);
+      gen.fill(&t[i], l);
+    }
+    EXPECT_EQ(s, t) << Corpus::name(static_cast<enum CORPUS>(c));
+  }
+  string s, t;
+  Corpus::generate(CORPUS_TANDEM, 100000, s, p);
+  size_t diff = 0;
+  for(size_t i = 37; i < s.size(); i++) diff += (s[i] != s[i - 37]);
+  EXPECT_GT(diff, (size_t) 100000 * 0.05);
+  EXPECT_LT(diff, (size_t) 100000 * 0.15);
+
+  // written with line breaks
+  FILE * fp = tmpfile();
+  ASSERT_TRUE(Corpus::write(CORPUS_TANDEM, 100000, fileno(fp), p, 60));
+  rewind(fp);
+  char line[128];
+  while(fgets(line, sizeof(line), fp)){
+    size_t l = strlen(line);
+    EXPECT_TRUE(l == 61 || (l == 100000 % 60 + 1 && t.size() + l - 1 == s.size()));
+    t.append(line, l - 1);
+  }
+  EXPECT_EQ(s, t);
+  fclose(fp);
+}
+
+TEST(corpus, random){
+  string s1, s2;
+  Corpus::generate(CORPUS_RANDOM_DNA, 1000, s1, 7);
+  Corpus::generate(CORPUS_RANDOM_DNA, 1000, s2, 7);
+  EXPECT_EQ(s1, s2);
+  EXPECT_EQ(s1.find_first_not_of("acgt"), string::npos);
+  Corpus::generate(CORPUS_RANDOM_DNA, 1000, s2, 8);
+  EXPECT_NE(s1, s2);
+  for(unsigned int c = 0; c < NUM_CORPORA; c++){
+    enum CORPUS p;
+    EXPECT_TRUE(Corpus::parse(Corpus::name(static_cast<enum CORPUS>(c)), p));
+    EXPECT_EQ(p, static_cast<enum CORPUS>(c));
+    Corpus::generate(p, 4096, s1);
+    EXPECT_EQ(s1.size(), (size_t) 4096);
+  }
+}
+
+// stats accumulate over calls and do not change the result
+TEST(corpus, stats){
+  string s;
+  RunStats stats;
+  Corpus::generate(CORPUS_FIBONACCI, 1 << 16, s);
+  unsigned int c = runFinder::countRuns(s);
+  EXPECT_EQ(runFinder::countRuns(s, USE_LPF_ORIGINAL, &stats), c);
+  double t = stats.totalSeconds();
+  EXPECT_GT(t, 0);
+  EXPECT_EQ(stats.type1Runs + stats.type2Runs, (size_t) c);
+  EXPECT_GT(stats.type2Runs, (size_t) 0);
+  EXPECT_GE(stats.arrayBytes[STAGE_SUFFIX_SORT], s.size() * sizeof(int));
+  EXPECT_GE(stats.processPeakRss[STAGE_TYPE2], stats.totalArrayBytes() / 2);
+  UIntArray POS, LEN;
+  LZ77::lpf(s, POS, LEN);
+  size_t factors = 1;
+  for(size_t i = 1; i < s.size(); i += max(1u, LEN[i])) factors++;
+  EXPECT_EQ(stats.factors, factors);
+  runFinder::countRuns(s, USE_LPF_ORIGINAL, &stats);
+  EXPECT_GT(stats.totalSeconds(), t);
+  EXPECT_EQ(stats.factors, 2 * factors);
+  stats.clear();
+  EXPECT_EQ(stats.totalSeconds(), 0);
+}
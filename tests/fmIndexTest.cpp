@@ -0,0 +1,133 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// fmIndexTest.cpp
+// test routines for rank structures and the FM-index
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2011 Hideo Bannai
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include <set>
+#include <algorithm>
+#include "../fmIndex.hpp"
+#include "../divsufsort.h"
+
+using namespace std;
+
+TEST(fmIndex, rankBitVector){
+  srand(3);
+  unsigned int sizes[] = {0, 1, 63, 64, 65, 511, 512, 513, 5000};
+  for(unsigned int k = 0; k < sizeof(sizes) / sizeof(sizes[0]); k++){
+    unsigned int n = sizes[k], ones = 0;
+    vector<bool> b(n);
+    RankBitVector bv;
+    bv.init(n);
+    for(unsigned int i = 0; i < n; i++){
+      if(rand() % 3 == 0){
+	b[i] = true;
+	bv.set(i);
+      }
+    }
+    bv.build();
+    for(unsigned int i = 0; i <= n; i++){
+      ASSERT_EQ(bv.rank1(i), ones) << n << " " << i;
+      if(i < n){
+	EXPECT_EQ(bv.get(i), b[i]);
+	ones += b[i];
+      }
+    }
+  }
+}
+
+TEST(fmIndex, waveletMatrix){
+  srand(4);
+  for(unsigned int levels = 1; levels <= 8; levels++){
+    unsigned int n = 1000;
+    vector<unsigned char> codes(n), work;
+    for(unsigned int i = 0; i < n; i++) codes[i] = rand() % (1 << levels);
+    work = codes;
+    WaveletMatrix wm;
+    wm.build(&work[0], n, levels);
+    vector<unsigned int> count(1 << levels, 0);
+    for(unsigned int i = 0; i < n; i++){
+      unsigned int c;
+      ASSERT_EQ(wm.access(i), codes[i]);
+      EXPECT_EQ(wm.inverseSelect(i, c), count[codes[i]]);
+      EXPECT_EQ(c, codes[i]);
+      if(i % 97 == 0){
+	for(c = 0; c < count.size(); c++) EXPECT_EQ(wm.rank(c, i), count[c]);
+      }
+      count[codes[i]]++;
+    }
+  }
+}
+
+// rows, backward search and locate agree with the suffix array
+TEST(fmIndex, fmIndex){
+  srand(5);
+  for(unsigned int t = 0; t < 100; t++){
+    unsigned int n = rand() % 300, rate = 1 + t % 7;
+    string s(n, 'a');
+    for(unsigned int i = 0; i < n; i++) s[i] = "acgt$\xff"[rand() % (2 + t % 5)];
+    const unsigned char * p = reinterpret_cast<const unsigned char *>(s.data());
+    vector<int> sa(n + 1);
+    if(n > 0) divsufsort(p, &sa[1], n);
+    sa[0] = n;                           // row 0 is the empty suffix
+    FMIndex fm(p, n, rate);
+    ASSERT_EQ(fm.rows(), n + 1);
+    for(unsigned int r = 0; r <= n; r++) ASSERT_EQ(fm.locate(r), (unsigned int) sa[r]) << t << " " << r;
+    // the rows of each pattern s[i..i+l) are those of the suffixes it begins
+    for(unsigned int i = 0; i < n; i += 1 + rand() % 5){
+      for(unsigned int l = 1; i + l <= n && l < 8; l++){
+	unsigned int lo = 0, hi = fm.rows();
+	for(unsigned int k = l; k-- > 0;) ASSERT_TRUE(fm.extend(p[i+k], lo, hi));
+	unsigned int occ = 0;
+	for(unsigned int r = 0; r <= n; r++){
+	  bool match = s.compare(sa[r], l, s, i, l) == 0;
+	  EXPECT_EQ(match, lo <= r && r < hi);
+	  occ += match;
+	}
+	EXPECT_EQ(hi - lo, occ);
+      }
+    }
+    unsigned int lo = 0, hi = fm.rows();
+    EXPECT_FALSE(fm.extend('z', lo, hi));
+  }
+}
+
+TEST(fmIndex, successorSet){
+  srand(6);
+  unsigned int sizes[] = {1, 64, 100, 4096, 4097, 300000};
+  for(unsigned int k = 0; k < sizeof(sizes) / sizeof(sizes[0]); k++){
+    unsigned int n = sizes[k];
+    SuccessorSet ss(n);
+    set<unsigned int> ref;
+    EXPECT_EQ(ss.next(0), SuccessorSet::NONE);
+    for(unsigned int j = 0; j < 200; j++){
+      unsigned int x = rand() % n;
+      ss.insert(x);
+      ref.insert(x);
+      for(unsigned int q = 0; q < 20; q++){
+	unsigned int y = rand() % n;
+	set<unsigned int>::const_iterator it = ref.lower_bound(y);
+	ASSERT_EQ(ss.next(y), it == ref.end() ? SuccessorSet::NONE : *it) << n << " " << y;
+      }
+    }
+  }
+}
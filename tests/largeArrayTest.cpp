@@ -0,0 +1,73 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// largeArrayTest.cpp
+// test routines for the placement of large arrays
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2011 Hideo Bannai
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <gtest/gtest.h>
+#include "../largeArray.hpp"
+#include "../runFinder.hpp"
+#include "../corpus.hpp"
+
+using namespace std;
+
+TEST(largeArray, parse){
+  const char * valid[] = { "default", "hugepage", "interleave", "local",
+			   "hugepage,interleave", "local,hugepage" };
+  const char * invalid[] = { "", "huge", "hugepage,", ",local", "interleave,local", "default,hugepage" };
+  unsigned int f;
+  for(unsigned int i = 0; i < sizeof(valid) / sizeof(valid[0]); i++){
+    EXPECT_TRUE(LargeArray::parse(valid[i], f)) << valid[i];
+    unsigned int g = ~0u;
+    EXPECT_TRUE(LargeArray::parse(LargeArray::name(f).c_str(), g));
+    EXPECT_EQ(f, g);
+  }
+  for(unsigned int i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++){
+    EXPECT_FALSE(LargeArray::parse(invalid[i], f)) << invalid[i];
+  }
+  EXPECT_TRUE(LargeArray::parse("hugepage,interleave", f));
+  EXPECT_EQ(f, (unsigned int) (ALLOC_HUGEPAGE | ALLOC_INTERLEAVE));
+  EXPECT_EQ(LargeArray::name(0), "default");
+  EXPECT_EQ(LargeArray::name(ALLOC_LOCAL | ALLOC_HUGEPAGE), "hugepage,local");
+}
+
+// placement changes neither the arrays nor the runs
+TEST(largeArray, assign){
+  const unsigned int policies[] = { 0, ALLOC_HUGEPAGE, ALLOC_INTERLEAVE,
+				    ALLOC_HUGEPAGE | ALLOC_LOCAL };
+  string s;
+  Corpus::generate(CORPUS_FIBONACCI, 1 << 20, s);
+  const unsigned char * t = reinterpret_cast<const unsigned char *>(s.data());
+  unsigned int c = runFinder::countRuns(s);
+  for(unsigned int p = 0; p < sizeof(policies) / sizeof(policies[0]); p++){
+    RunFinderContext ctx(MemoryResource::heap(), 0);
+    ctx.options().alloc = policies[p];
+    vector<unsigned int> v(10, 7);
+    LargeArray::assign(v, LargeArray::MIN_BYTES, policies[p]);
+    ASSERT_EQ(v.size(), LargeArray::MIN_BYTES);
+    unsigned int nonzero = 0;
+    for(size_t i = 0; i < v.size(); i++) nonzero += (v[i] != 0);
+    EXPECT_EQ(nonzero, 0u);
+    LargeArray::assign(v, 3, policies[p]);
+    EXPECT_EQ(v.size(), 3u);
+    EXPECT_EQ(ctx.countRuns(t, s.size(), USE_LPF_ORIGINAL), c);
+    EXPECT_EQ(ctx.countRuns(t, s.size(), USE_LZ_KKP), c);
+  }
+}
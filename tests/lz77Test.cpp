@@ -0,0 +1,204 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// lz77Test.cpp
+// test routines for lz factorization
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2011 Hideo Bannai
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include "../lz77.hpp"
+#include "../runFinder.hpp"
+#include "../corpus.hpp"
+
+using namespace std;
+
+static vector<string> inputs(){
+  vector<string> in;
+  string s;
+  srand(5);
+  for(unsigned int c = 0; c < NUM_CORPORA; c++){
+    Corpus::generate(static_cast<enum CORPUS>(c), 3000, s);
+    in.push_back(s);
+  }
+  for(unsigned int i = 0; i < 200; i++){
+    s.resize(rand() % 100);
+    for(unsigned int j = 0; j < s.size(); j++) s[j] = "abc"[rand() % (1 + i % 3)];
+    in.push_back(s);
+  }
+  return in;
+}
+
+// every algorithm gives factors of the longest previous factor lengths
+TEST(lz77, factorize){
+  vector<string> in = inputs();
+  for(unsigned int t = 0; t < in.size(); t++){
+    const unsigned char * s = reinterpret_cast<const unsigned char *>(in[t].data());
+    unsigned int n = in[t].size();
+    UIntArray POS, LEN;
+    LZ77::lpf(in[t], POS, LEN);
+    for(unsigned int a = 0; a < NUM_ALGFLAGS; a++){
+      LZFactors lz;
+      LZ77::factorize(s, n, lz, static_cast<enum ALGFLAG>(a));
+      unsigned int i = 0;
+      for(unsigned int f = 0; f < lz.size(); f++){
+	ASSERT_EQ(lz[f].beg, i);
+	EXPECT_EQ(lz[f].len, LEN[i]) << LZ77::name(static_cast<enum ALGFLAG>(a));
+	if(lz[f].len == 0){
+	  EXPECT_EQ(lz[f].src, i);
+	} else {
+	  EXPECT_LT(lz[f].src, i);
+	  EXPECT_EQ(in[t].compare(lz[f].src, lz[f].len, in[t], i, lz[f].len), 0);
+	}
+	i += max(1u, lz[f].len);
+      }
+      EXPECT_EQ(i, n);
+    }
+  }
+}
+
+// the std::vector overloads give the same arrays and factors
+TEST(lz77, stdVector){
+  vector<string> in = inputs();
+  for(unsigned int t = 0; t < in.size(); t++){
+    const unsigned char * s = reinterpret_cast<const unsigned char *>(in[t].data());
+    unsigned int n = in[t].size();
+    UIntArray POS, LEN;
+    vector<unsigned int> vpos, vlen;
+    LZ77::lpf(in[t], POS, LEN, USE_LPF_PEAK);
+    LZ77::lpf(in[t], vpos, vlen, USE_LPF_PEAK);
+    EXPECT_TRUE(vpos == vector<unsigned int>(POS.begin(), POS.end()));
+    EXPECT_TRUE(vlen == vector<unsigned int>(LEN.begin(), LEN.end()));
+    LZFactors lz;
+    vector<LZFactor> vlz(1, LZFactor(0, 0, 0)), olz;
+    LZ77::factorize(s, n, lz);
+    LZ77::factorize(s, n, vlz);
+    OnlineLZ77 online;
+    online.push(s, n / 2, olz);
+    online.push(s + n / 2, n - n / 2, olz);
+    online.finish(olz);
+    ASSERT_EQ(vlz.size(), lz.size());
+    ASSERT_EQ(olz.size(), lz.size());
+    for(unsigned int f = 0; f < lz.size(); f++){
+      EXPECT_EQ(vlz[f].beg, lz[f].beg);
+      EXPECT_EQ(vlz[f].len, lz[f].len);
+      EXPECT_EQ(olz[f].beg, lz[f].beg);
+      EXPECT_EQ(olz[f].len, lz[f].len);
+    }
+  }
+}
+
+// full lpf arrays by peak elimination agree with LPF_original
+TEST(lz77, lpfPeak){
+  vector<string> in = inputs();
+  for(unsigned int t = 0; t < in.size(); t++){
+    UIntArray POS, LEN, PPOS, PLEN;
+    LZ77::lpf(in[t], POS, LEN);
+    LZ77::lpf(in[t], PPOS, PLEN, USE_LPF_PEAK);
+    ASSERT_EQ(PLEN.size(), in[t].size());
+    for(unsigned int i = 0; i < in[t].size(); i++){
+      ASSERT_EQ(PLEN[i], LEN[i]) << i;
+      if(PLEN[i] == 0){
+	EXPECT_EQ(PPOS[i], i);
+      } else {
+	EXPECT_LT(PPOS[i], i);
+	EXPECT_EQ(in[t].compare(PPOS[i], PLEN[i], in[t], i, PLEN[i]), 0);
+      }
+    }
+  }
+}
+
+// LPF_parallel gives the same arrays as LPF_original, for any number of threads
+TEST(lz77, lpfParallel){
+  vector<string> in = inputs();
+  unsigned int threads[] = {1, 2, 3, 7, 16};
+  for(unsigned int t = 0; t < in.size(); t++){
+    UIntArray POS, LEN, PPOS, PLEN;
+    LZ77::lpf(in[t], POS, LEN);
+    for(unsigned int k = 0; k < sizeof(threads) / sizeof(threads[0]); k++){
+      RunOptions opts;
+      opts.lzThreads = threads[k];
+      LZ77::lpf(in[t], PPOS, PLEN, USE_LPF_PARALLEL, NULL, NULL, opts);
+      ASSERT_TRUE(PPOS == POS) << t << " " << threads[k];
+      ASSERT_TRUE(PLEN == LEN) << t << " " << threads[k];
+    }
+  }
+}
+
+// and the same runs
+TEST(lz77, runs){
+  vector<string> in = inputs();
+  for(unsigned int t = 0; t < in.size(); t++){
+    vector<run> expected, runs;
+    runFinder::findRuns(in[t], expected, USE_LPF_ORIGINAL);
+    for(unsigned int a = 0; a < NUM_ALGFLAGS; a++){
+      runFinder::findRuns(in[t], runs, static_cast<enum ALGFLAG>(a));
+      ASSERT_EQ(runs.size(), expected.size()) << LZ77::name(static_cast<enum ALGFLAG>(a));
+      for(unsigned int r = 0; r < runs.size(); r++){
+	EXPECT_EQ(runs[r].b_pos, expected[r].b_pos);
+	EXPECT_EQ(runs[r].e_pos, expected[r].e_pos);
+	EXPECT_EQ(runs[r].period, expected[r].period);
+      }
+    }
+  }
+}
+
+// runs of text pushed in pieces are those of the whole text
+TEST(lz77, onlineRuns){
+  vector<string> in = inputs();
+  srand(7);
+  for(unsigned int t = 0; t < in.size(); t++){
+    const unsigned char * s = reinterpret_cast<const unsigned char *>(in[t].data());
+    unsigned int n = in[t].size(), i = 0, m;
+    vector<run> expected, runs;
+    OnlineRunFinder orf;
+    while(i < n){
+      m = min(n - i, 1u + rand() % (1 + t % 50));
+      orf.push(s + i, m);
+      i += m;
+    }
+    orf.finish();
+    orf.runs(runs);
+    runFinder::findRuns(in[t], expected);
+    EXPECT_EQ(orf.size(), n);
+    EXPECT_EQ(orf.runCount(), expected.size());
+    ASSERT_EQ(runs.size(), expected.size());
+    for(unsigned int r = 0; r < runs.size(); r++){
+      EXPECT_EQ(runs[r].b_pos, expected[r].b_pos);
+      EXPECT_EQ(runs[r].e_pos, expected[r].e_pos);
+      EXPECT_EQ(runs[r].period, expected[r].period);
+    }
+  }
+}
+
+// factors are emitted before the end of the text
+TEST(lz77, onlineLatency){
+  OnlineLZ77 olz;
+  LZFactors lz;
+  olz.push(reinterpret_cast<const unsigned char *>("abaababa"), 8, lz);
+  ASSERT_EQ(lz.size(), 4u);              // a, b, a, aba; ba is still open
+  EXPECT_EQ(lz[3].beg, 3u);
+  EXPECT_EQ(lz[3].len, 3u);
+  EXPECT_EQ(lz[3].src, 0u);
+  olz.finish(lz);
+  ASSERT_EQ(lz.size(), 5u);
+  EXPECT_EQ(lz[4].beg, 6u);
+  EXPECT_EQ(lz[4].len, 2u);
+  EXPECT_EQ(lz[4].src, 1u);
+}
@@ -0,0 +1,206 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// memoryResourceTest.cpp
+// test routines for memory resources
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2011 Hideo Bannai
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <gtest/gtest.h>
+#include <cstring>
+#include "../memoryResource.hpp"
+#include "../runFinder.hpp"
+#include "../corpus.hpp"
+
+using namespace std;
+
+// the peak is the most bytes outstanding at once
+TEST(memoryResource, counting){
+  CountingResource c(MemoryResource::heap());
+  void * p = c.allocate(100, 8), * q = c.allocate(50, 8);
+  c.deallocate(p, 100, 8);
+  EXPECT_EQ(c.outstanding(), 50u);
+  EXPECT_EQ(c.peak(), 150u);
+  c.resetPeak();
+  EXPECT_EQ(c.peak(), 50u);
+  c.deallocate(q, 50, 8);
+  EXPECT_EQ(c.outstanding(), 0u);
+  EXPECT_EQ(c.allocations(), 2u);
+}
+
+TEST(memoryResource, monotonic){
+  CountingResource up;
+  MonotonicResource arena(1024, &up);
+  EXPECT_EQ(arena.bytes(), 0u);
+  const size_t aligns[] = { 1, 2, 4, 8, 16, 64 };
+  for(unsigned int i = 0; i < 100; i++){
+    size_t a = aligns[i % 6];
+    char * p = static_cast<char *>(arena.allocate(i * 37 + 1, a));
+    EXPECT_EQ(reinterpret_cast<size_t>(p) % a, 0u);
+    memset(p, i, i * 37 + 1);
+  }
+  EXPECT_GT(arena.bytes(), 100 * 37u);
+  EXPECT_EQ(up.outstanding(), arena.bytes());
+  EXPECT_LT(up.allocations(), 20u);             // chunks grow geometrically
+  // the last allocation is given back
+  void * p = arena.allocate(100, 8);
+  arena.deallocate(p, 100, 8);
+  EXPECT_EQ(arena.allocate(100, 8), p);
+  arena.release();
+  EXPECT_EQ(arena.bytes(), 0u);
+  EXPECT_EQ(up.outstanding(), 0u);
+  EXPECT_EQ(MemoryResource::current(), MemoryResource::heap());
+  {
+    ResourceScope scope(&arena);
+    EXPECT_EQ(MemoryResource::current(), &arena);
+    ResourceVector<int>::type v(1000, 1);
+    EXPECT_EQ(v.get_allocator().res, &arena);
+  }
+  EXPECT_EQ(MemoryResource::current(), MemoryResource::heap());
+}
+
+// all engines give the same runs with an arena, which serves the arrays
+TEST(memoryResource, runs){
+  string s;
+  Corpus::generate(CORPUS_FIBONACCI, 1 << 14, s);
+  vector<run> expect;
+  runFinder::findRuns(s, expect);
+  CountingResource up;
+  for(unsigned int a = 0; a < NUM_ALGFLAGS; a++){
+    MonotonicResource arena(1 << 12, &up);
+    {
+      ResourceScope scope(&arena);
+      ResourceVector<run>::type runs;
+      runFinder::findRuns(s, runs, static_cast<enum ALGFLAG>(a));
+      ASSERT_EQ(runs.size(), expect.size()) << LZ77::name(static_cast<enum ALGFLAG>(a));
+      for(unsigned int i = 0; i < runs.size(); i++){
+	EXPECT_EQ(runs[i].b_pos, expect[i].b_pos);
+	EXPECT_EQ(runs[i].e_pos, expect[i].e_pos);
+	EXPECT_EQ(runs[i].period, expect[i].period);
+      }
+    }
+    EXPECT_GT(arena.bytes(), 4 * s.size());
+    arena.release();
+    EXPECT_EQ(up.outstanding(), 0u);
+  }
+}
+
+// arrays of another resource are filled by copying
+TEST(memoryResource, mixed){
+  string s;
+  Corpus::generate(CORPUS_RANDOM_DNA, 1 << 12, s);
+  UIntArray POS, LEN, APOS, ALEN;
+  LZ77::lpf(s, POS, LEN);
+  MonotonicResource arena;
+  {
+    ResourceScope scope(&arena);
+    LZ77::lpf(s, APOS, ALEN);
+  }
+  EXPECT_EQ(APOS.get_allocator().res, MemoryResource::heap());
+  EXPECT_TRUE(POS == APOS);
+  EXPECT_TRUE(LEN == ALEN);
+  arena.release();
+  EXPECT_TRUE(LEN == ALEN);
+}
+
+TEST(memoryResource, pool){
+  CountingResource up;
+  PoolResource pool(&up);
+  vector<void *> ps;
+  for(size_t b = 0; b < 5000; b += 7) ps.push_back(pool.allocate(b, 8));
+  size_t allocs = up.allocations();
+  EXPECT_EQ(pool.allocations(), allocs);
+  EXPECT_EQ(pool.bytes(), up.outstanding());
+  for(size_t i = 0; i < ps.size(); i++){
+    EXPECT_EQ(reinterpret_cast<size_t>(ps[i]) % 16, 0u);
+    memset(ps[i], 1, i * 7);
+    pool.deallocate(ps[i], i * 7, 8);
+  }
+  // the same sizes again come from the free lists
+  for(size_t b = 0, i = 0; b < 5000; b += 7, i++) ps[i] = pool.allocate(b, 8);
+  EXPECT_EQ(up.allocations(), allocs);
+  for(size_t i = 0; i < ps.size(); i++) pool.deallocate(ps[i], i * 7, 8);
+  void * p = pool.allocate(100, 64);
+  EXPECT_EQ(reinterpret_cast<size_t>(p) % 64, 0u);
+  pool.deallocate(p, 100, 64);
+  pool.release();
+  EXPECT_EQ(pool.bytes(), 0u);
+  EXPECT_EQ(up.outstanding(), 0u);
+}
+
+// a warm context takes nothing from upstream, and gives the runs of runFinder
+TEST(memoryResource, context){
+  string s1, s2;
+  Corpus::generate(CORPUS_RANDOM_DNA, 1 << 13, s1);
+  Corpus::generate(CORPUS_FIBONACCI, 1 << 12, s2);
+  for(unsigned int a = 0; a < NUM_ALGFLAGS; a++){
+    enum ALGFLAG algf = static_cast<enum ALGFLAG>(a);
+    CountingResource up;
+    RunFinderContext ctx(&up);
+    vector<run> runs, expect;
+    ctx.findRuns(reinterpret_cast<const unsigned char *>(s1.data()), s1.size(), runs, algf);
+    ctx.countRuns(reinterpret_cast<const unsigned char *>(s2.data()), s2.size(), algf);
+    size_t allocs = up.allocations();
+    EXPECT_GT(allocs, 0u);
+    EXPECT_EQ(ctx.allocations(), allocs);
+    for(unsigned int r = 0; r < 3; r++){
+      const string & s = (r % 2) ? s2 : s1;
+      ctx.findRuns(reinterpret_cast<const unsigned char *>(s.data()), s.size(), runs, algf);
+      runFinder::findRuns(s, expect, algf);
+      ASSERT_EQ(runs.size(), expect.size()) << LZ77::name(algf);
+      for(unsigned int i = 0; i < runs.size(); i++){
+	EXPECT_EQ(runs[i].b_pos, expect[i].b_pos);
+	EXPECT_EQ(runs[i].e_pos, expect[i].e_pos);
+	EXPECT_EQ(runs[i].period, expect[i].period);
+      }
+      EXPECT_EQ(ctx.countRuns(reinterpret_cast<const unsigned char *>(s.data()), s.size(), algf),
+		runs.size());
+    }
+    EXPECT_EQ(up.allocations(), allocs) << LZ77::name(algf);
+    EXPECT_EQ(up.outstanding(), ctx.bytes());
+    ctx.clear();
+    EXPECT_EQ(up.outstanding(), 0u);
+  }
+}
+
+// the free lists of a pool hold at most maxFree bytes, and a context with
+// a small maxFree does not keep the arrays of all stages
+TEST(memoryResource, poolMaxFree){
+  CountingResource up;
+  PoolResource pool(&up, 10000);
+  vector<void *> ps;
+  for(size_t b = 1000; b <= 8000; b += 1000) ps.push_back(pool.allocate(b, 8));
+  for(size_t i = 0; i < ps.size(); i++) pool.deallocate(ps[i], 1000 * (i + 1), 8);
+  EXPECT_LE(pool.freeListBytes(), 10000u);
+  EXPECT_EQ(pool.bytes(), up.outstanding());
+  EXPECT_EQ(pool.bytes(), pool.freeListBytes());
+  void * p = pool.allocate(1000, 8);
+  pool.deallocate(p, 1000, 8);
+  pool.release();
+  EXPECT_EQ(up.outstanding(), 0u);
+
+  string s;
+  Corpus::generate(CORPUS_RUN_RICH, 1 << 16, s);
+  CountingResource up2;
+  RunFinderContext ctx(&up2, 1 << 16), warm(&up);
+  vector<run> runs;
+  ctx.findRuns(reinterpret_cast<const unsigned char *>(s.data()), s.size(), runs);
+  warm.findRuns(reinterpret_cast<const unsigned char *>(s.data()), s.size(), runs);
+  EXPECT_LE(ctx.bytes(), (size_t) 1 << 16);
+  EXPECT_GT(warm.bytes(), (size_t) 20 << 16);
+}
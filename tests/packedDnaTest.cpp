@@ -0,0 +1,115 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// packedDnaTest.cpp
+// test routines for packed dna text
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2011 Hideo Bannai
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include "../packedDna.hpp"
+#include "../runFinder.hpp"
+#include "../corpus.hpp"
+
+using namespace std;
+
+// dna with some other symbols
+static string randomDna(unsigned int n, unsigned int period, unsigned int exceptions){
+  string s(n, 'A');
+  for(unsigned int i = 0; i < n; i++){
+    s[i] = (period > 0 && i >= period) ? s[i - period] : "ACGT"[rand() % 4];
+    if(exceptions > 0 && rand() % exceptions == 0) s[i] = "Nn-"[rand() % 3];
+  }
+  return s;
+}
+
+TEST(packedDna, mode){
+  enum DNAMODE m;
+  for(unsigned int k = 0; k < NUM_DNAMODES; k++){
+    ASSERT_TRUE(PackedDNA::parse(PackedDNA::name(static_cast<enum DNAMODE>(k)), m));
+    EXPECT_EQ(m, static_cast<enum DNAMODE>(k));
+  }
+  EXPECT_FALSE(PackedDNA::parse("yes", m));
+  EXPECT_EQ(RunOptions().dna, DNA_OFF);
+  PackedDNA dna;
+  string s = randomDna(1000, 0, 0);
+  EXPECT_TRUE(dna.pack(reinterpret_cast<const unsigned char *>(s.data()), s.size(), DNA_AUTO));
+  EXPECT_LT(dna.bytes(), s.size() / 4 + 64);
+  Corpus::generate(CORPUS_RANDOM_DNA, 1000, s);   // lower case bases
+  EXPECT_TRUE(dna.pack(reinterpret_cast<const unsigned char *>(s.data()), s.size(), DNA_AUTO));
+  EXPECT_EQ(dna[0], (unsigned char) s[0]);
+  s = randomDna(1000, 0, 8);
+  EXPECT_FALSE(dna.pack(reinterpret_cast<const unsigned char *>(s.data()), s.size(), DNA_AUTO));
+  EXPECT_TRUE(dna.empty());
+  EXPECT_TRUE(dna.pack(reinterpret_cast<const unsigned char *>(s.data()), s.size(), DNA_ON));
+  s = randomDna(1000, 0, 0);
+  EXPECT_FALSE(dna.pack(reinterpret_cast<const unsigned char *>(s.data()), s.size(), DNA_OFF));
+}
+
+// extensions agree with byte by byte comparison
+TEST(packedDna, lce){
+  srand(11);
+  for(unsigned int t = 0; t < 40; t++){
+    string s = randomDna(200 + rand() % 300, (t % 4) ? 1 + rand() % 40 : 0, (t % 3) ? 5 + t : 0);
+    unsigned int n = s.size();
+    PackedDNA dna;
+    ASSERT_TRUE(dna.pack(reinterpret_cast<const unsigned char *>(s.data()), n, DNA_ON));
+    for(unsigned int p = 0; p < n; p++) ASSERT_EQ(dna[p], (unsigned char) s[p]);
+    for(unsigned int q = 0; q < 2000; q++){
+      unsigned int i = rand() % (n + 1), j = rand() % (n + 1), l;
+      unsigned int m = n - max(i, j);
+      for(l = 0; l < m && s[i + l] == s[j + l]; l++);
+      ASSERT_EQ(dna.lce(i, j, m), l) << s << " " << i << " " << j;
+      EXPECT_EQ(dna.lce(i, j, m / 2), min(l, m / 2));
+      m = min(i, j);
+      for(l = 0; l < m && s[i - 1 - l] == s[j - 1 - l]; l++);
+      ASSERT_EQ(dna.lcs(i, j, m), l) << s << " " << i << " " << j;
+      EXPECT_EQ(dna.lcs(i, j, m / 2), min(l, m / 2));
+    }
+  }
+}
+
+// the runs and lz factors are the same with the packed text
+TEST(packedDna, runs){
+  srand(12);
+  vector<string> in;
+  string s;
+  Corpus::generate(CORPUS_RANDOM_DNA, 1 << 14, s);
+  in.push_back(s);
+  Corpus::generate(CORPUS_FIBONACCI, 1 << 12, s);
+  in.push_back(s);
+  for(unsigned int t = 0; t < 20; t++) in.push_back(randomDna(500 + rand() % 3000, rand() % 30, 30 + t));
+  RunFinderContext ctx;
+  ctx.options().dna = DNA_ON;
+  for(unsigned int k = 0; k < in.size(); k++){
+    const unsigned char * t = reinterpret_cast<const unsigned char *>(in[k].data());
+    for(unsigned int a = 0; a < NUM_ALGFLAGS; a++){
+      enum ALGFLAG algf = static_cast<enum ALGFLAG>(a);
+      vector<run> r1, r2;
+      runFinder::findRuns(in[k], r1, algf);
+      ctx.findRuns(t, in[k].size(), r2, algf);
+      ASSERT_EQ(r1.size(), r2.size()) << k << " " << LZ77::name(algf);
+      for(unsigned int i = 0; i < r1.size(); i++){
+	EXPECT_EQ(r1[i].b_pos, r2[i].b_pos);
+	EXPECT_EQ(r1[i].e_pos, r2[i].e_pos);
+	EXPECT_EQ(r1[i].period, r2[i].period);
+      }
+    }
+  }
+}
@@ -0,0 +1,54 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// perfCountersTest.cpp
+// test routines for hardware performance counters
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2011 Hideo Bannai
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <gtest/gtest.h>
+#include "../perfCounters.hpp"
+#include "../runFinder.hpp"
+#include "../corpus.hpp"
+
+using namespace std;
+
+// counters that are not available read as 0, and are left out of stats
+TEST(perfCounters, stats){
+  PerfCounters perf;
+  unsigned long long v[NUM_COUNTERS];
+  perf.read(v);
+  for(unsigned int c = 0; c < NUM_COUNTERS; c++){
+    if(!perf.available(static_cast<enum COUNTER>(c))){
+      EXPECT_EQ(v[c], 0ULL);
+    }
+  }
+
+  string s;
+  RunStats stats;
+  stats.perf = &perf;
+  Corpus::generate(CORPUS_RANDOM_BINARY, 1 << 14, s);
+  runFinder::countRuns(s, USE_LPF_ORIGINAL, &stats);
+  EXPECT_EQ(stats.counted, perf.availableMask());
+  string json = stats.json();
+  EXPECT_EQ(json.find("\"instructions\"") != string::npos, perf.available(COUNTER_INSTRUCTIONS));
+  if(perf.available(COUNTER_INSTRUCTIONS)){
+    EXPECT_GT(stats.counters[STAGE_SUFFIX_SORT][COUNTER_INSTRUCTIONS], 0ULL);
+    EXPECT_GT(stats.counters[STAGE_TYPE1][COUNTER_INSTRUCTIONS], 0ULL);
+  }
+}
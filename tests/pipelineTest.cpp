@@ -0,0 +1,255 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// pipelineTest.cpp
+// test routines for the reader / compute / writer pipeline
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2011 Hideo Bannai
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <unistd.h>
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+#include "../pipeline.hpp"
+#include "../trace.hpp"
+
+using namespace std;
+
+static string slurp(FILE * fp){
+  string s;
+  char b[4096];
+  size_t r;
+  rewind(fp);
+  while((r = fread(b, 1, sizeof(b), fp)) > 0) s.append(b, r);
+  return s;
+}
+
+static string fastaInput(unsigned int nrecs, unsigned int maxlen){
+  string in;
+  srand(3);
+  for(unsigned int r = 0; r < nrecs; r++){
+    char name[32];
+    snprintf(name, sizeof(name), ">r%u\n", r);
+    in += name;
+    unsigned int len = 1 + rand() % maxlen;
+    for(unsigned int i = 0; i < len; i++){
+      in.push_back("ab"[rand() % 2]);
+      if(i % 60 == 59) in.push_back('\n');
+    }
+    in.push_back('\n');
+  }
+  return in;
+}
+
+static string runPipeline(const vector<const char *> & files, unsigned int workers){
+  FILE * fp = tmpfile();
+  {
+    RunWriter writer(fileno(fp), RUNS_TSV);
+    writer.writeHeader();
+    RunPipeline p(writer, workers);
+    p.setBatchBytes(1000);
+    p.setQueueDepth(2);
+    EXPECT_TRUE(p.process(files));
+  }
+  string out = slurp(fp);
+  fclose(fp);
+  return out;
+}
+
+// output is the same, and in input order, for any number of workers
+TEST(pipeline, workers){
+  char path[] = "/tmp/runFinderTestXXXXXX";
+  int fd = mkstemp(path);
+  ASSERT_GE(fd, 0);
+  string in = fastaInput(200, 300);
+  ASSERT_EQ(write(fd, in.data(), in.size()), (ssize_t) in.size());
+  close(fd);
+  vector<const char *> files(1, path);
+
+  string expected;
+  for(unsigned int w = 1; w <= 4; w++){
+    string out = runPipeline(files, w);
+    if(w == 1) expected = out;
+    EXPECT_EQ(out, expected);
+  }
+  EXPECT_NE(expected.find("\nr199\t"), string::npos);
+
+  // unreadable files are reported
+  FILE * fp = tmpfile();
+  RunWriter writer(fileno(fp), RUNS_TSV);
+  RunPipeline p(writer, 2);
+  files.push_back("/nonexistent/file");
+  EXPECT_FALSE(p.process(files));
+  EXPECT_FALSE(p.error().empty());
+  fclose(fp);
+  unlink(path);
+}
+
+// records wrapped over several lines have the runs of the unwrapped ones:
+// the sequence bytes left behind the joined lines are not part of it
+TEST(pipeline, lineBreaks){
+  vector<string> seqs;
+  seqs.push_back("AAAA");
+  seqs.push_back("ACACACGTGTGT");
+  srand(5);
+  for(unsigned int r = 0; r < 20; r++){
+    string t;
+    unsigned int len = 1 + rand() % 200;
+    for(unsigned int i = 0; i < len; i++) t.push_back("ab"[rand() % 2]);
+    seqs.push_back(t);
+  }
+  const unsigned int widths[] = { 0, 1, 2, 3, 7, 60 };   // 0: one line
+  string expected;
+  for(unsigned int w = 0; w < sizeof(widths) / sizeof(widths[0]); w++){
+    string in;
+    for(unsigned int r = 0; r < seqs.size(); r++){
+      char name[32];
+      snprintf(name, sizeof(name), ">r%u\n", r);
+      in += name;
+      for(unsigned int i = 0; i < seqs[r].size(); i++){
+	in.push_back(seqs[r][i]);
+	if(widths[w] && i % widths[w] == widths[w] - 1) in.push_back('\n');
+      }
+      if(in[in.size() - 1] != '\n') in.push_back('\n');
+    }
+    char path[] = "/tmp/runFinderTestXXXXXX";
+    int fd = mkstemp(path);
+    ASSERT_GE(fd, 0);
+    ASSERT_EQ(write(fd, in.data(), in.size()), (ssize_t) in.size());
+    close(fd);
+    string out = runPipeline(vector<const char *>(1, path), 1);
+    unlink(path);
+    if(w == 0) expected = out;
+    EXPECT_EQ(out, expected) << "width " << widths[w];
+  }
+  EXPECT_NE(expected.find("\nr0\t"), string::npos);
+}
+
+// statistics are written for each record and sum up to the runs written
+TEST(pipeline, stats){
+  char path[] = "/tmp/runFinderTestXXXXXX";
+  int fd = mkstemp(path);
+  ASSERT_GE(fd, 0);
+  string in = fastaInput(20, 300);
+  ASSERT_EQ(write(fd, in.data(), in.size()), (ssize_t) in.size());
+  close(fd);
+  FILE * fp = tmpfile(), * sp = tmpfile();
+  RunWriter writer(fileno(fp), RUNS_TSV);
+  RunPipeline p(writer, 2);
+  p.setBatchBytes(1000);
+  p.setStatsOutput(sp);
+  EXPECT_TRUE(p.process(vector<const char *>(1, path)));
+  writer.flush();
+  string out = slurp(fp), st = slurp(sp);
+  EXPECT_EQ(p.records(), (size_t) 20);
+  EXPECT_EQ(count(st.begin(), st.end(), '\n'), 20);
+  EXPECT_NE(st.find("\n{\"record\": 19, \"name\": \"r19\""), string::npos);
+  const RunStats & t = p.totalStats();
+  EXPECT_EQ(t.type1Runs + t.type2Runs, (size_t) count(out.begin(), out.end(), '\n'));
+  EXPECT_GT(t.factors, (size_t) 20);
+  fclose(fp);
+  fclose(sp);
+  unlink(path);
+}
+
+// compressed input is decoded in blocks, with records spanning blocks
+TEST(pipeline, compressed){
+  char path[] = "/tmp/runFinderTestXXXXXX";
+  int fd = mkstemp(path);
+  ASSERT_GE(fd, 0);
+  string in = fastaInput(50, 5000);
+  ASSERT_EQ(write(fd, in.data(), in.size()), (ssize_t) in.size());
+  close(fd);
+  string expected = runPipeline(vector<const char *>(1, path), 2);
+  string cpath = string(path) + ".c";
+  vector<const char *> files(1, cpath.c_str());
+#ifdef HAVE_ZLIB
+  {
+    // two gzip members
+    gzFile gz = gzopen(cpath.c_str(), "wb");
+    gzwrite(gz, in.data(), in.size() / 2);
+    gzclose(gz);
+    gz = gzopen(cpath.c_str(), "ab");
+    gzwrite(gz, in.data() + in.size() / 2, in.size() - in.size() / 2);
+    gzclose(gz);
+    EXPECT_EQ(runPipeline(files, 2), expected);
+  }
+#endif
+#ifdef HAVE_ZSTD
+  {
+    string z(ZSTD_compressBound(in.size()), 0);
+    z.resize(ZSTD_compress(&z[0], z.size(), in.data(), in.size(), 3));
+    FILE * fp = fopen(cpath.c_str(), "wb");
+    fwrite(z.data(), 1, z.size(), fp);
+    fclose(fp);
+    EXPECT_EQ(runPipeline(files, 2), expected);
+  }
+#endif
+  unlink(cpath.c_str());
+  unlink(path);
+}
+
+// a record longer than many decoded blocks gives the runs of the mapped
+// file, and is not parsed again for each block
+TEST(pipeline, longRecord){
+#ifdef HAVE_ZLIB
+  string in = ">short\nabaab\n>long\n";
+  srand(6);
+  for(unsigned int i = 0; i < 100000; i++){
+    in.push_back("ab"[rand() % 2]);
+    if(i % 60 == 59) in.push_back('\n');
+  }
+  in += "\n>last\naabaab\n";
+  char path[] = "/tmp/runFinderTestXXXXXX";
+  int fd = mkstemp(path);
+  ASSERT_GE(fd, 0);
+  ASSERT_EQ(write(fd, in.data(), in.size()), (ssize_t) in.size());
+  close(fd);
+  string expected = runPipeline(vector<const char *>(1, path), 1);
+  string cpath = string(path) + ".gz";
+  gzFile gz = gzopen(cpath.c_str(), "wb");
+  gzwrite(gz, in.data(), in.size());
+  gzclose(gz);
+  if(Trace::available()) Trace::start();
+  EXPECT_EQ(runPipeline(vector<const char *>(1, cpath.c_str()), 1), expected);
+  if(Trace::available()){
+    // about 100 blocks of 1000 bytes: parsed when the carry doubles
+    string tpath = string(path) + ".json";
+    ASSERT_TRUE(Trace::write(tpath.c_str()));
+    Trace::stop();
+    FILE * fp = fopen(tpath.c_str(), "r");
+    string t = slurp(fp);
+    fclose(fp);
+    unsigned int parses = 0;
+    for(size_t p = 0; (p = t.find("\"name\": \"parse\"", p)) != string::npos; p++) parses++;
+    EXPECT_GT(parses, 0u);
+    EXPECT_LT(parses, 30u);
+    unlink(tpath.c_str());
+  }
+  unlink(cpath.c_str());
+  unlink(path);
+#endif
+}
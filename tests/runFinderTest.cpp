@@ -23,7 +23,11 @@
 
 #include <gtest/gtest.h>
 #include <sys/time.h>
+#include <pthread.h>
 #include "../runFinder.hpp"
+#include "../corpus.hpp"
+#include "../largeArray.hpp"
+#include "../suffixArray.hpp"
 #include "../bits.h"
 
 using namespace std;
@@ -44,3 +48,118 @@ TEST(runFinder, countRuns){
   EXPECT_EQ(c1, (unsigned int) 1455);
   return;
 }
+
+// runs of a slice of a larger buffer are those of the copied slice, even
+// if the buffer continues a run past the end of the slice
+TEST(runFinder, slice){
+  string bufs[] = { "aaaaa", "xyz110111010101110110110111010101110", "abaababaabaababaababaabaab" };
+  for(unsigned int b = 0; b < sizeof(bufs) / sizeof(bufs[0]); b++){
+    const string & buf = bufs[b];
+    for(unsigned int l = 1; l < buf.size(); l++){
+      string s1 = buf.substr(0, l);
+      vector<unsigned short> w(buf.begin(), buf.end());
+      for(unsigned int a = 0; a < NUM_ALGFLAGS; a++){
+	enum ALGFLAG algf = static_cast<enum ALGFLAG>(a);
+	vector<run> r1, r2, r3;
+	runFinder::findRuns(s1, r1, algf);
+	runFinder::findRuns(reinterpret_cast<const unsigned char *>(buf.data()), l, r2, algf);
+	runFinder::findRuns(&w[0], l, r3, algf);
+	ASSERT_EQ(r1.size(), r2.size()) << buf << " " << l << " " << LZ77::name(algf);
+	ASSERT_EQ(r1.size(), r3.size()) << buf << " " << l << " " << LZ77::name(algf);
+	for(unsigned int i = 0; i < r1.size(); i++){
+	  EXPECT_EQ(r1[i].b_pos, r2[i].b_pos);
+	  EXPECT_EQ(r1[i].e_pos, r2[i].e_pos);
+	  EXPECT_EQ(r1[i].period, r2[i].period);
+	  EXPECT_EQ(r1[i].b_pos, r3[i].b_pos);
+	  EXPECT_EQ(r1[i].e_pos, r3[i].e_pos);
+	  EXPECT_EQ(r1[i].period, r3[i].period);
+	}
+      }
+    }
+  }
+  runFinder rc;
+  vector<run> r;
+  rc.findRuns(reinterpret_cast<const unsigned char *>("aaaaa"), 4, r);
+  ASSERT_EQ(r.size(), (size_t) 1);
+  EXPECT_EQ(r[0].b_pos, 0u);
+  EXPECT_EQ(r[0].e_pos, 3u);
+  EXPECT_EQ(r[0].period, 1u);
+}
+
+// the peak memory of run finding, measured from its allocations, is
+// within the budget of runFinder.hpp
+TEST(runFinder, memoryBudget){
+  for(unsigned int k = 0; k < NUM_CORPORA; k++){
+    string s;
+    CountingResource res(MemoryResource::heap());
+    RunStats stats;
+    Corpus::generate(static_cast<enum CORPUS>(k), 1 << 16, s);
+    size_t n = s.size(), c;
+    {
+      ResourceScope scope(&res);
+      c = runFinder::countRuns(s, USE_LPF_ORIGINAL, &stats);
+    }
+    // plus a few words of padding (and the packed dna, if it is on)
+    size_t budget = max(12 * n, 4 * n + 24 * c) + 12 * (stats.factors + stats.type1Runs) + n / 4 + 256;
+    EXPECT_LE(res.peak(), budget) << Corpus::name(static_cast<enum CORPUS>(k));
+    EXPECT_EQ(res.outstanding(), 0u);
+    // and the sizes reported by stage
+    EXPECT_LE(stats.arrayBytes[STAGE_SUFFIX_SORT] + stats.arrayBytes[STAGE_RANK_LCP], 12 * n);
+    EXPECT_LE(stats.arrayBytes[STAGE_TYPE2], 4 * (n + 1) + 2 * 8 * c);
+  }
+}
+
+// a context and the options it counts the runs of the texts with
+class OptionsArg {
+public:
+  const vector<string> * in;
+  RunOptions opts;
+  enum ALGFLAG algf;
+  vector<unsigned int> counts;
+};
+
+static void * countWithOptions(void * arg){
+  OptionsArg * a = static_cast<OptionsArg *>(arg);
+  RunFinderContext ctx;
+  ctx.options() = a->opts;
+  for(unsigned int r = 0; r < 4; r++){
+    for(unsigned int k = 0; k < a->in->size(); k++){
+      const string & s = (*a->in)[k];
+      a->counts.push_back(ctx.countRuns(reinterpret_cast<const unsigned char *>(s.data()),
+					s.size(), a->algf));
+    }
+  }
+  return NULL;
+}
+
+// the options of a context are its own: contexts with different options
+// in different threads find the runs of the defaults
+TEST(runFinder, options){
+  vector<string> in;
+  string s;
+  for(unsigned int c = 0; c < NUM_CORPORA; c++){
+    Corpus::generate(static_cast<enum CORPUS>(c), 3000, s);
+    in.push_back(s);
+  }
+  OptionsArg a[2];
+  a[0].opts.sorter = SuffixSorter::find("sais");
+  a[0].opts.lzThreads = 3;
+  a[0].opts.dna = DNA_ON;
+  a[0].algf = USE_LPF_PARALLEL;
+  a[1].opts.sorter = SuffixSorter::find("auto");
+  a[1].opts.smallSort = 0;
+  a[1].opts.alloc = ALLOC_HUGEPAGE;
+  a[1].algf = USE_LZ_KKP;
+  pthread_t t[2];
+  for(unsigned int i = 0; i < 2; i++){
+    a[i].in = &in;
+    ASSERT_EQ(pthread_create(&t[i], NULL, countWithOptions, &a[i]), 0);
+  }
+  for(unsigned int i = 0; i < 2; i++) pthread_join(t[i], NULL);
+  for(unsigned int i = 0; i < 2; i++){
+    ASSERT_EQ(a[i].counts.size(), 4 * in.size());
+    for(unsigned int k = 0; k < a[i].counts.size(); k++){
+      EXPECT_EQ(a[i].counts[k], runFinder::countRuns(in[k % in.size()])) << i << " " << k;
+    }
+  }
+}
@@ -0,0 +1,152 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// runIOTest.cpp
+// test routines for run output formats
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2011 Hideo Bannai
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <string>
+#include <unistd.h>
+#include "../runIO.hpp"
+
+using namespace std;
+
+static string contents(FILE * fp){
+  string s;
+  char b[4096];
+  size_t r;
+  rewind(fp);
+  while((r = fread(b, 1, sizeof(b), fp)) > 0) s.append(b, r);
+  return s;
+}
+
+TEST(runIO, text){
+  FILE * fp = tmpfile();
+  vector<run> runs;
+  runFinder::findRuns("aabaab", runs);
+  {
+    RunWriter w(fileno(fp), RUNS_TEXT);
+    w.writeHeader();
+    w.writeRecord("x", 1, 6, runs);
+  }
+  EXPECT_EQ(contents(fp), ">x\n# of runs = 3\n([0,1],1)\n([0,5],3)\n([3,4],1)\n");
+  fclose(fp);
+}
+
+TEST(runIO, tsv){
+  FILE * fp = tmpfile();
+  vector<run> runs;
+  runFinder::findRuns("abab", runs);
+  {
+    RunWriter w(fileno(fp), RUNS_TSV);
+    w.writeHeader();
+    w.writeRecord("", 0, 4, runs);
+    w.writeRecord("y", 1, 4, runs);
+  }
+  EXPECT_EQ(contents(fp), "#name\tb_pos\te_pos\tperiod\n0\t0\t3\t2\ny\t0\t3\t2\n");
+  fclose(fp);
+}
+
+TEST(runIO, binary){
+  FILE * fp = tmpfile();
+  string s1 = "110111010101110110", s2 = "aabaabaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa";
+  vector<run> r1, r2, r;
+  runFinder::findRuns(s1, r1);
+  runFinder::findRuns(s2, r2);
+  {
+    // a tiny buffer exercises the flushing paths
+    RunWriter w(fileno(fp), RUNS_BINARY, 64);
+    w.writeHeader();
+    w.writeRecord("first", 5, s1.size(), r1);
+    w.writeRecord("", 0, s2.size(), r2);
+  }
+  rewind(fp);
+  lseek(fileno(fp), 0, SEEK_SET);
+  RunReader rd(fileno(fp), 64);
+  string name;
+  unsigned int len;
+  ASSERT_TRUE(rd.readHeader());
+  ASSERT_TRUE(rd.readRecord(name, len, r));
+  EXPECT_EQ(name, "first");
+  EXPECT_EQ(len, s1.size());
+  ASSERT_EQ(r.size(), r1.size());
+  for(unsigned int i = 0; i < r.size(); i++){
+    EXPECT_EQ(r[i].b_pos, r1[i].b_pos);
+    EXPECT_EQ(r[i].e_pos, r1[i].e_pos);
+    EXPECT_EQ(r[i].period, r1[i].period);
+  }
+  ASSERT_TRUE(rd.readRecord(name, len, r));
+  EXPECT_EQ(name, "");
+  ASSERT_EQ(r.size(), r2.size());
+  EXPECT_EQ(r.back().e_pos, r2.back().e_pos);
+  EXPECT_FALSE(rd.readRecord(name, len, r));
+  EXPECT_TRUE(rd.error().empty());
+  fclose(fp);
+}
+
+static void putVarint(string & s, unsigned long long v){
+  do {
+    s.push_back((char) ((v & 0x7f) | (v > 0x7f ? 0x80 : 0)));
+    v >>= 7;
+  } while(v > 0);
+}
+
+// the error of reading a binary record of sequence length slen and count
+// runs (of which only the first is there)
+static string corruptRecord(unsigned long long slen, unsigned long long count,
+			    unsigned long long d = 0, unsigned long long l = 2,
+			    unsigned long long p = 1){
+  FILE * fp = tmpfile();
+  string s("RUNF\x01\0\0\0", 8);
+  putVarint(s, 1);
+  s += "x";
+  putVarint(s, slen);
+  putVarint(s, count);
+  putVarint(s, d); putVarint(s, l); putVarint(s, p);
+  fwrite(s.data(), 1, s.size(), fp);
+  fflush(fp);
+  lseek(fileno(fp), 0, SEEK_SET);
+  RunReader rd(fileno(fp));
+  string name;
+  unsigned int len;
+  vector<run> r;
+  EXPECT_TRUE(rd.readHeader());
+  EXPECT_FALSE(rd.readRecord(name, len, r));
+  EXPECT_LE(r.capacity(), s.size());
+  fclose(fp);
+  return rd.error();
+}
+
+// corrupt counts are rejected without allocating for them, and corrupt
+// runs before their fields can wrap
+TEST(runIO, corrupt){
+  EXPECT_EQ(corruptRecord(100, 1ULL << 40), "more runs than symbols");
+  EXPECT_EQ(corruptRecord(1ULL << 40, 3), "sequence length out of range");
+  EXPECT_EQ(corruptRecord(0xffffffffULL, 0xfffffffeULL), "truncated or corrupt varint");
+  EXPECT_EQ(corruptRecord(10, 2), "truncated or corrupt varint");
+  EXPECT_EQ(corruptRecord(10, 1, 9, 2, 1), "run out of range");
+  EXPECT_EQ(corruptRecord(10, 1, ~0ULL - 1, 2, 1), "run out of range");
+  EXPECT_EQ(corruptRecord(10, 1, 0, 0, 1), "run out of range");
+  EXPECT_EQ(corruptRecord(10, 1, 2, ~0ULL - 1, 1), "run out of range");
+  EXPECT_EQ(corruptRecord(10, 1, 0, 5, 0), "run period out of range");
+  EXPECT_EQ(corruptRecord(10, 1, 0, 5, 3), "run period out of range");
+  EXPECT_EQ(corruptRecord(10, 1, 0, 10, 1ULL << 32), "run period out of range");
+}
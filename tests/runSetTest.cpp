@@ -0,0 +1,85 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// runSetTest.cpp
+// test routines for the compressed run set
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2011 Hideo Bannai
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include <string>
+#include "../runFinder.hpp"
+
+using namespace std;
+
+static void checkSet(const string & s){
+  vector<run> runs;
+  RunSet rs;
+  runFinder::findRuns(s, runs);
+  runFinder::findRuns(s, rs);
+  ASSERT_EQ(rs.size(), runs.size());
+  // sequential and random access
+  unsigned int i = 0;
+  for(RunSet::const_iterator it = rs.begin(); it != rs.end(); ++it, i++){
+    run r = *it, q = rs[i];
+    EXPECT_EQ(r.b_pos, runs[i].b_pos);
+    EXPECT_EQ(r.e_pos, runs[i].e_pos);
+    EXPECT_EQ(r.period, runs[i].period);
+    EXPECT_EQ(q.b_pos, runs[i].b_pos);
+    EXPECT_EQ(q.e_pos, runs[i].e_pos);
+  }
+  EXPECT_EQ(i, runs.size());
+  // lookup by begin position
+  for(unsigned int b = 0; b < s.size(); b += 7){
+    size_t first = 0, last;
+    while(first < runs.size() && runs[first].b_pos < b) first++;
+    last = first;
+    while(last < runs.size() && runs[last].b_pos < b + 13) last++;
+    pair<RunSet::const_iterator, RunSet::const_iterator> r = rs.startingIn(b, b + 13);
+    EXPECT_EQ(rs.lowerBound(b), first);
+    EXPECT_EQ(r.first.index(), first);
+    EXPECT_EQ(r.second.index(), last);
+  }
+}
+
+TEST(runSet, matchesVector){
+  string s;
+  checkSet("");
+  checkSet("a");
+  checkSet("110111010101110110");
+  checkSet(string(1000, 'a'));
+  srand(1);
+  for(unsigned int k = 0; k < 20; k++){
+    s.clear();
+    for(unsigned int i = 0; i < 500 + k * 100; i++) s.push_back('a' + rand() % (2 + k % 3));
+    checkSet(s);
+  }
+  // run rich fibonacci string
+  string f0 = "0", f1 = "01";
+  while(f1.size() < 20000){ string t = f1 + f0; f0 = f1; f1 = t; }
+  checkSet(f1);
+}
+
+TEST(runSet, compact){
+  string f0 = "0", f1 = "01";
+  while(f1.size() < 100000){ string t = f1 + f0; f0 = f1; f1 = t; }
+  RunSet rs;
+  runFinder::findRuns(f1, rs);
+  EXPECT_LT(rs.bytes(), rs.size() * sizeof(run) / 2);
+}
@@ -0,0 +1,65 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// scalingTest.cpp
+// test routines for empirical scaling
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2011 Hideo Bannai
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include "../scaling.hpp"
+#include "../corpus.hpp"
+#include "../runFinder.hpp"
+
+using namespace std;
+
+TEST(scaling, exponent){
+  vector<double> n, y;
+  for(double x = 1000; x < 1e6; x *= 2){
+    n.push_back(x);
+    y.push_back(3 * x * sqrt(x));
+  }
+  EXPECT_NEAR(scalingExponent(n, y), 1.5, 1e-9);
+  y[0] = 0;                               // ignored
+  EXPECT_NEAR(scalingExponent(n, y), 1.5, 1e-9);
+  EXPECT_EQ(scalingExponent(vector<double>(1, 1), vector<double>(1, 1)), 0);
+}
+
+// the memory and the work of the run scans (symbols compared by the type 1
+// scans, runs checked by type 2) are linear on every corpus. a quadratic
+// scan, such as the naive type 1 scans of one long factor of unary,
+// gives an exponent near 2.
+TEST(scaling, linearMemory){
+  string s;
+  for(unsigned int c = 0; c < NUM_CORPORA; c++){
+    vector<double> n, bytes, checks;
+    for(size_t len = 1 << 13; len <= (1 << 16); len *= 2){
+      RunStats stats;
+      Corpus::generate(static_cast<enum CORPUS>(c), len, s);
+      runFinder::countRuns(s, USE_LPF_ORIGINAL, &stats);
+      n.push_back(len);
+      bytes.push_back(stats.totalArrayBytes());
+      checks.push_back(stats.candidates[STAGE_TYPE1] + stats.candidates[STAGE_TYPE2] + len);
+      // every symbol of a factor is compared at least once
+      EXPECT_GE(stats.candidates[STAGE_TYPE1], len - 1) << Corpus::name(static_cast<enum CORPUS>(c));
+    }
+    EXPECT_LT(scalingExponent(n, bytes), 1.1) << Corpus::name(static_cast<enum CORPUS>(c));
+    EXPECT_LT(scalingExponent(n, checks), 1.1) << Corpus::name(static_cast<enum CORPUS>(c));
+  }
+}
@@ -0,0 +1,112 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// seqReaderTest.cpp
+// test routines for sequence file parsing
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2011 Hideo Bannai
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include "../seqReader.hpp"
+
+using namespace std;
+
+static string seqOf(const SeqRecord & r){ return string(r.seq, r.len); }
+
+TEST(seqReader, raw){
+  string buf = "  abab\nbaab  aa\n";
+  vector<SeqRecord> recs;
+  SeqParser parser;
+  EXPECT_EQ(parser.parse(&buf[0], buf.size(), true, recs), buf.size());
+  EXPECT_EQ(parser.format(), SEQ_RAW);
+  ASSERT_EQ(recs.size(), (size_t) 3);
+  EXPECT_EQ(seqOf(recs[0]), "abab");
+  EXPECT_EQ(seqOf(recs[2]), "aa");
+  EXPECT_EQ(recs[1].name_len, (size_t) 0);
+}
+
+TEST(seqReader, fasta){
+  string buf = ">seq1 some description\nACGT\r\nAC\n\nGT\n>seq2\nAAAA\n>empty\n";
+  vector<SeqRecord> recs;
+  SeqParser parser;
+  parser.parse(&buf[0], buf.size(), true, recs);
+  EXPECT_TRUE(parser.error().empty());
+  ASSERT_EQ(recs.size(), (size_t) 3);
+  EXPECT_EQ(recs[0].getName(), "seq1");
+  EXPECT_EQ(seqOf(recs[0]), "ACGTACGT");
+  EXPECT_EQ(recs[1].getName(), "seq2");
+  EXPECT_EQ(seqOf(recs[1]), "AAAA");
+  EXPECT_EQ(recs[2].getName(), "empty");
+  EXPECT_EQ(recs[2].len, (size_t) 0);
+}
+
+// records longer than the engines take are rejected, not truncated.
+// the limit is lowered to fake records of 2^32 symbols.
+TEST(seqReader, tooLong){
+  EXPECT_EQ(SeqParser::MAX_LEN, (size_t) 0xffffffffu);
+  string buf = ">a\nACGT\n>b\nAC\nGTA\n>c\nA\n";
+  vector<SeqRecord> recs;
+  SeqParser parser;
+  parser.setMaxLength(4);
+  EXPECT_EQ(parser.parse(&buf[0], buf.size(), true, recs), buf.find(">b"));
+  ASSERT_EQ(recs.size(), (size_t) 1);
+  EXPECT_EQ(parser.error(), "record b has 5 symbols, more than 4");
+  string raw = "ab abcde";
+  SeqParser rawParser(SEQ_RAW);
+  rawParser.setMaxLength(4);
+  recs.clear();
+  rawParser.parse(&raw[0], raw.size(), true, recs);
+  EXPECT_EQ(recs.size(), (size_t) 1);
+  EXPECT_EQ(rawParser.error(), "record has 5 symbols, more than 4");
+}
+
+TEST(seqReader, fastq){
+  string buf = "@r1\nACGT\n+\n@@@@\n@r2 x\nAC\nGT\n+r2\nII\nII\n";
+  vector<SeqRecord> recs;
+  SeqParser parser;
+  parser.parse(&buf[0], buf.size(), true, recs);
+  EXPECT_TRUE(parser.error().empty());
+  ASSERT_EQ(recs.size(), (size_t) 2);
+  EXPECT_EQ(recs[0].getName(), "r1");
+  EXPECT_EQ(seqOf(recs[0]), "ACGT");
+  EXPECT_EQ(recs[1].getName(), "r2");
+  EXPECT_EQ(seqOf(recs[1]), "ACGT");
+
+  string bad = "@r1\nACGT\n";
+  SeqParser badParser;
+  recs.clear();
+  badParser.parse(&bad[0], bad.size(), true, recs);
+  EXPECT_FALSE(badParser.error().empty());
+}
+
+// records that may continue past the end of the buffer are left unconsumed
+TEST(seqReader, partial){
+  string buf = ">a\nAC\nGT\n>b\nTT";
+  vector<SeqRecord> recs;
+  SeqParser parser;
+  size_t used = parser.parse(&buf[0], buf.size(), false, recs);
+  ASSERT_EQ(recs.size(), (size_t) 1);
+  EXPECT_EQ(seqOf(recs[0]), "ACGT");
+  EXPECT_EQ(buf.substr(used), ">b\nTT");
+  string rest = buf.substr(used) + "GG\n";
+  parser.parse(&rest[0], rest.size(), true, recs);
+  ASSERT_EQ(recs.size(), (size_t) 2);
+  EXPECT_EQ(seqOf(recs[1]), "TTGG");
+}
@@ -0,0 +1,170 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// suffixArrayTest.cpp
+// test routines for suffix arrays
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2011 Hideo Bannai
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include "../suffixArray.hpp"
+#include "../runFinder.hpp"
+#include "../corpus.hpp"
+#include "../divsufsort.h"
+#include "../saIs.hpp"
+
+using namespace std;
+
+// the small text sort gives the suffix array of divsufsort
+TEST(suffixArray, smallSort){
+  vector<string> in;
+  string s;
+  srand(7);
+  for(unsigned int c = 0; c < NUM_CORPORA; c++){
+    Corpus::generate(static_cast<enum CORPUS>(c), SuffixArrayAux::SMALL_LIMIT, s);
+    in.push_back(s);
+    in.push_back(s.substr(0, 150));
+  }
+  for(unsigned int i = 0; i < 300; i++){
+    s.resize(rand() % 300);
+    for(unsigned int j = 0; j < s.size(); j++) s[j] = "ab\xff"[rand() % (1 + i % 3)];
+    in.push_back(s);
+  }
+  RunFinderContext small, large;
+  small.options().smallSort = SuffixArrayAux::SMALL_LIMIT;
+  large.options().smallSort = 0;
+  for(unsigned int k = 0; k < in.size(); k++){
+    const unsigned char * t = reinterpret_cast<const unsigned char *>(in[k].data());
+    uInt n = in[k].size();
+    vector<int> sa(n + 1), expect(n + 1);
+    SuffixArrayAux::sort(t, &sa[0], n, small.options());
+    divsufsort(t, &expect[0], n);
+    ASSERT_TRUE(sa == expect) << k;
+  }
+  // the runs are the same with both sorts
+  vector<run> r1, r2;
+  for(unsigned int k = 0; k < in.size(); k++){
+    const unsigned char * t = reinterpret_cast<const unsigned char *>(in[k].data());
+    small.findRuns(t, in[k].size(), r1);
+    large.findRuns(t, in[k].size(), r2);
+    ASSERT_EQ(r1.size(), r2.size()) << k;
+    for(unsigned int i = 0; i < r1.size(); i++){
+      EXPECT_EQ(r1[i].b_pos, r2[i].b_pos);
+      EXPECT_EQ(r1[i].e_pos, r2[i].e_pos);
+      EXPECT_EQ(r1[i].period, r2[i].period);
+    }
+  }
+}
+
+// SA-IS gives the suffix array of divsufsort, for all symbol types
+TEST(suffixArray, saIs){
+  srand(8);
+  for(unsigned int k = 0; k < 200; k++){
+    string s;
+    if(k < NUM_CORPORA){
+      Corpus::generate(static_cast<enum CORPUS>(k), 5000, s);
+    } else {
+      s.resize(rand() % 1000);
+      for(unsigned int j = 0; j < s.size(); j++) s[j] = "abcd"[rand() % (1 + k % 4)];
+    }
+    const unsigned char * t = reinterpret_cast<const unsigned char *>(s.data());
+    uInt n = s.size();
+    vector<int> expect(n + 1), sa(n + 1);
+    divsufsort(t, &expect[0], n);
+    saIs(t, &sa[0], n, 256);
+    ASSERT_TRUE(sa == expect) << k;
+    // order preserving wider symbols, dense and sparse
+    vector<unsigned short> w16(t, t + n);
+    vector<unsigned int> w32(n);
+    for(unsigned int i = 0; i < n; i++) w32[i] = t[i] * 16777259u;
+    sa.assign(n + 1, 0);
+    BasicSuffixArray<unsigned short>::sort(n ? &w16[0] : NULL, &sa[0], n);
+    ASSERT_TRUE(sa == expect) << k;
+    sa.assign(n + 1, 0);
+    BasicSuffixArray<unsigned int>::sort(n ? &w32[0] : NULL, &sa[0], n);
+    ASSERT_TRUE(sa == expect) << k;
+  }
+}
+
+// the runs of a text of wider symbols are those of the same text of bytes
+TEST(suffixArray, wideRuns){
+  string s;
+  Corpus::generate(CORPUS_RUN_RICH, 1 << 12, s);
+  vector<unsigned int> w(s.size());
+  for(unsigned int i = 0; i < s.size(); i++) w[i] = 1000000 - (unsigned char) s[i];
+  vector<run> expect;
+  runFinder::findRuns(s, expect);
+  for(unsigned int a = 0; a < NUM_ALGFLAGS; a++){
+    enum ALGFLAG algf = static_cast<enum ALGFLAG>(a);
+    vector<run> runs;
+    runFinder::findRuns(&w[0], w.size(), runs, algf);
+    ASSERT_EQ(runs.size(), expect.size()) << LZ77::name(algf);
+    for(unsigned int i = 0; i < runs.size(); i++){
+      EXPECT_EQ(runs[i].b_pos, expect[i].b_pos);
+      EXPECT_EQ(runs[i].e_pos, expect[i].e_pos);
+      EXPECT_EQ(runs[i].period, expect[i].period);
+    }
+    EXPECT_EQ(runFinder::countRuns(&w[0], w.size(), algf), expect.size());
+  }
+}
+
+// counts the texts sorted by the registered test backend
+static unsigned int countedCalls = 0;
+
+static void sortCounted(const unsigned char * t, int * sa, uInt n){
+  divsufsort(t, sa, n);
+  countedCalls++;
+}
+
+// every registered backend gives the suffix array of divsufsort, and the
+// runs do not depend on the backend
+TEST(suffixArray, backends){
+  EXPECT_TRUE(RunOptions().sorter == NULL);
+  EXPECT_STREQ(SuffixSorter::nameOf(NULL), "default");
+  EXPECT_TRUE(SuffixSorter::find("unknown") == NULL);
+  EXPECT_TRUE(SuffixSorter::find("sais") != NULL);
+  EXPECT_TRUE(SuffixSorter::add("test", "divsufsort, counted", sortCounted, 100));
+  EXPECT_FALSE(SuffixSorter::add("test", "again", sortCounted));
+  string s;
+  Corpus::generate(CORPUS_RUN_RICH, 1 << 12, s);
+  vector<run> expect;
+  runFinder::findRuns(s, expect);
+  for(unsigned int b = 0; b < SuffixSorter::count(); b++){
+    RunFinderContext ctx;
+    ctx.options().sorter = SuffixSorter::find(SuffixSorter::get(b).name);
+    ASSERT_TRUE(ctx.options().sorter == &SuffixSorter::get(b));
+    const char * name = SuffixSorter::nameOf(ctx.options().sorter);
+    for(unsigned int c = 0; c < NUM_CORPORA; c++){
+      for(uInt n = 0; n <= 3000; n = n * 3 + 1){
+	string t;
+	Corpus::generate(static_cast<enum CORPUS>(c), n, t);
+	const unsigned char * u = reinterpret_cast<const unsigned char *>(t.data());
+	vector<int> want(n + 1), sa(n + 1);
+	divsufsort(u, &want[0], n);
+	SuffixArrayAux::sort(u, &sa[0], n, ctx.options());
+	ASSERT_TRUE(sa == want) << name << " " << Corpus::name(static_cast<enum CORPUS>(c)) << " " << n;
+      }
+    }
+    vector<run> runs;
+    ctx.findRuns(reinterpret_cast<const unsigned char *>(s.data()), s.size(), runs);
+    EXPECT_EQ(runs.size(), expect.size()) << name;
+  }
+  // texts longer than its maxLength are sorted by auto
+  EXPECT_EQ(countedCalls, 5 * (unsigned int) NUM_CORPORA);
+}
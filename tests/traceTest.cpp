@@ -0,0 +1,89 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// traceTest.cpp
+// test routines for thread timeline tracing
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2011 Hideo Bannai
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <pthread.h>
+#include <unistd.h>
+#include "../trace.hpp"
+
+using namespace std;
+
+#ifndef NO_TRACE
+
+static string slurp(const char * path){
+  string s;
+  char b[4096];
+  size_t r;
+  FILE * fp = fopen(path, "r");
+  while((r = fread(b, 1, sizeof(b), fp)) > 0) s.append(b, r);
+  fclose(fp);
+  return s;
+}
+
+static size_t occurrences(const string & s, const string & p){
+  size_t c = 0;
+  for(size_t i = s.find(p); i != string::npos; i = s.find(p, i + 1)) c++;
+  return c;
+}
+
+static void * traced(void *){
+  Trace::setThreadName("traced");
+  for(long i = 0; i < 10; i++){
+    TraceSpan span("inner", i);
+  }
+  return NULL;
+}
+
+TEST(trace, threads){
+  char path[] = "/tmp/runFinderTraceXXXXXX";
+  close(mkstemp(path));
+  Trace::start(4);
+  pthread_t t;
+  {
+    TraceSpan span("outer");
+    ASSERT_EQ(pthread_create(&t, NULL, traced, NULL), 0);
+    pthread_join(t, NULL);
+  }
+  ASSERT_TRUE(Trace::write(path));
+  string s = slurp(path);
+  EXPECT_EQ(occurrences(s, "\"name\": \"outer\""), (size_t) 1);
+  EXPECT_EQ(occurrences(s, "\"name\": \"traced\""), (size_t) 1);
+  // only the last 4 spans of the ring are kept
+  EXPECT_EQ(occurrences(s, "\"name\": \"inner\""), (size_t) 4);
+  EXPECT_NE(s.find("\"args\": {\"n\": 9}"), string::npos);
+  EXPECT_EQ(s.find("\"args\": {\"n\": 5}"), string::npos);
+
+  // nothing is recorded after stop
+  Trace::stop();
+  {
+    TraceSpan span("outer");
+  }
+  ASSERT_TRUE(Trace::write(path));
+  EXPECT_EQ(occurrences(slurp(path), "\"name\""), (size_t) 0);
+  unlink(path);
+}
+
+#endif
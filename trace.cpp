@@ -0,0 +1,158 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// trace.cpp
+// timeline tracing of threads, written as chrome trace JSON
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2011 Hideo Bannai
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "trace.hpp"
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <pthread.h>
+#include <time.h>
+
+using namespace std;
+
+double Trace::now(){
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e6 + ts.tv_nsec * 1e-3;
+}
+
+#ifndef NO_TRACE
+
+bool traceEnabled = false;
+
+class TraceEvent {
+public:
+  const char * name;
+  long arg;
+  double begin, end;
+};
+
+// the spans of one thread
+class TraceBuffer {
+public:
+  vector<TraceEvent> events;
+  size_t next;                          // total number of spans recorded
+  unsigned int tid;
+  char tname[32];
+};
+
+static pthread_mutex_t traceMutex = PTHREAD_MUTEX_INITIALIZER;
+static vector<TraceBuffer *> traceBuffers;   // guarded by traceMutex
+static size_t traceCapacity = 0;
+static unsigned int traceGeneration = 0;     // incremented by start
+static __thread TraceBuffer * threadBuffer = NULL;
+static __thread unsigned int threadGeneration = 0;
+
+// the buffer of the calling thread, created on first use
+static TraceBuffer * buffer(){
+  if(threadBuffer == NULL || threadGeneration != traceGeneration){
+    TraceBuffer * b = new TraceBuffer;
+    b->events.resize(traceCapacity);
+    b->next = 0;
+    b->tname[0] = '\0';
+    pthread_mutex_lock(&traceMutex);
+    b->tid = traceBuffers.size() + 1;
+    traceBuffers.push_back(b);
+    pthread_mutex_unlock(&traceMutex);
+    threadBuffer = b;
+    threadGeneration = traceGeneration;
+  }
+  return threadBuffer;
+}
+
+bool Trace::available(){
+  return true;
+}
+
+void Trace::start(size_t capacity){
+  stop();
+  traceCapacity = capacity > 0 ? capacity : 1;
+  traceGeneration++;
+  traceEnabled = true;
+}
+
+void Trace::stop(){
+  traceEnabled = false;
+  pthread_mutex_lock(&traceMutex);
+  for(size_t i = 0; i < traceBuffers.size(); i++) delete traceBuffers[i];
+  traceBuffers.clear();
+  pthread_mutex_unlock(&traceMutex);
+  traceGeneration++;                    // threads must not touch the old buffers
+}
+
+void Trace::setThreadName(const char * name){
+  if(!traceEnabled) return;
+  TraceBuffer * b = buffer();
+  strncpy(b->tname, name, sizeof(b->tname) - 1);
+  b->tname[sizeof(b->tname) - 1] = '\0';
+}
+
+void Trace::record(const char * name, long arg, double begin, double end){
+  if(!traceEnabled) return;
+  TraceBuffer * b = buffer();
+  TraceEvent & e = b->events[b->next++ % b->events.size()];
+  e.name = name;
+  e.arg = arg;
+  e.begin = begin;
+  e.end = end;
+}
+
+bool Trace::write(const char * path){
+  FILE * fp = fopen(path, "w");
+  if(fp == NULL) return false;
+  const char * sep = "";
+  fprintf(fp, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [");
+  pthread_mutex_lock(&traceMutex);
+  for(size_t t = 0; t < traceBuffers.size(); t++){
+    const TraceBuffer * b = traceBuffers[t];
+    if(b->tname[0]){
+      fprintf(fp, "%s\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %u, "
+	      "\"args\": {\"name\": \"%s\"}}", sep, b->tid, b->tname);
+      sep = ",";
+    }
+    size_t n = b->events.size();
+    size_t i = (b->next > n) ? b->next - n : 0;
+    for(; i < b->next; i++){
+      const TraceEvent & e = b->events[i % n];
+      fprintf(fp, "%s\n{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %u, "
+	      "\"ts\": %.3f, \"dur\": %.3f", sep, e.name, b->tid, e.begin, e.end - e.begin);
+      if(e.arg >= 0) fprintf(fp, ", \"args\": {\"n\": %ld}", e.arg);
+      fputc('}', fp);
+      sep = ",";
+    }
+  }
+  pthread_mutex_unlock(&traceMutex);
+  fprintf(fp, "\n]}\n");
+  return (fclose(fp) == 0);
+}
+
+#else
+
+bool Trace::available(){ return false; }
+void Trace::start(size_t){}
+void Trace::stop(){}
+void Trace::setThreadName(const char *){}
+void Trace::record(const char *, long, double, double){}
+bool Trace::write(const char *){ return false; }
+
+#endif
@@ -0,0 +1,82 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// trace.hpp
+// timeline tracing of threads, written as chrome trace JSON
+//
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2011 Hideo Bannai
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __TRACE_HPP__
+#define __TRACE_HPP__
+
+#include <cstddef>
+
+// spans of time recorded by each thread, for viewing in chrome://tracing
+// or perfetto. each thread appends to its own ring buffer, so recording
+// takes no locks; when a buffer is full the oldest spans are overwritten.
+// span names must be string literals (they are stored by pointer).
+// compile with -DNO_TRACE to remove tracing altogether.
+class Trace {
+public:
+  // false if tracing was compiled out
+  static bool available();
+  // start recording, keeping at most capacity spans per thread.
+  // must be called before the traced threads are started.
+  static void start(size_t capacity = 1 << 16);
+  // stop recording and discard the spans recorded so far
+  static void stop();
+  // name of the calling thread in the timeline
+  static void setThreadName(const char * name);
+  // write the spans recorded so far as chrome trace JSON to path.
+  // the traced threads must have finished. false on write error.
+  static bool write(const char * path);
+  // microseconds of a monotonic clock
+  static double now();
+  static void record(const char * name, long arg, double begin, double end);
+};
+
+#ifndef NO_TRACE
+extern bool traceEnabled;
+
+// records a span from construction until end() or destruction.
+// arg (if not negative) is shown with the span, e.g. a record number.
+class TraceSpan {
+  const char * name;
+  long arg;
+  double begin;
+  bool active;
+public:
+  TraceSpan(const char * name_, long arg_ = -1)
+    : name(name_), arg(arg_), begin(0), active(traceEnabled) {
+    if(active) begin = Trace::now();
+  }
+  ~TraceSpan(){ end(); }
+  void end(){
+    if(active) Trace::record(name, arg, begin, Trace::now());
+    active = false;
+  }
+};
+#else
+class TraceSpan {
+public:
+  TraceSpan(const char *, long = -1){}
+  void end(){}
+};
+#endif
+
+#endif//__TRACE_HPP__